@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# The micro-benchmarks of the metrics
+#
+#-------------------------------------------------
+
+QT       = core
+CONFIG   += console
+CONFIG   -= app_bundle
+
+include(../GUI/Core.pri)
+
+TARGET = tsanalyzer-bench
+TEMPLATE = app
+
+
+SOURCES += main.cc
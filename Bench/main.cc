@@ -0,0 +1,320 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+#include "Compressor.h"
+#include "Generator.h"
+#include "Hurst.h"
+#include "SeriesBatch.h"
+#include "SeriesFile.h"
+#include "TimeSeries.h"
+
+namespace {
+/// The allocations made since the start, by malloc and friends where they can be caught, by new otherwise
+std::atomic <qint64> nAllocations {0}, allocatedBytes {0};
+
+inline void countAllocation (size_t size) {
+    nAllocations.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+}
+
+#ifdef __GLIBC__
+// QVector and the compressors allocate by malloc, operator new ends up there too
+extern "C" {
+void* __libc_malloc (size_t size);
+void* __libc_calloc (size_t n, size_t size);
+void* __libc_realloc (void* p, size_t size);
+
+void* malloc (size_t size) {
+    countAllocation (size);
+    return __libc_malloc (size);
+}
+void* calloc (size_t n, size_t size) {
+    countAllocation (n * size);
+    return __libc_calloc (n, size);
+}
+void* realloc (void* p, size_t size) {
+    countAllocation (size);
+    return __libc_realloc (p, size);
+}
+}
+#else
+void* operator new (size_t size) {
+    countAllocation (size);
+    if (void* p = std::malloc (size))
+        return p;
+    throw std::bad_alloc ();
+}
+void* operator new[] (size_t size) {
+    return operator new (size);
+}
+void operator delete (void* p) noexcept {
+    std::free (p);
+}
+void operator delete[] (void* p) noexcept {
+    std::free (p);
+}
+#endif
+
+namespace {
+/// Where the results go so that the calls are not optimized away
+volatile double sink;
+
+struct result_t {
+    QString name;
+    int length;
+    /// 0 for the kernels that don't depend on the codes
+    unsigned nLevels;
+    qint64 iterations;
+    double nsPerOp;
+    double bytesPerSecond;
+    double allocationsPerOp;
+    double allocatedBytesPerOp;
+};
+
+/**
+ * @brief run @p op until it takes @p minSeconds in total.
+ *
+ * The first call is a warm-up and is not measured: the caches, the FFT plans
+ * and the compressor memory are ready by then, as they are when many series are analysed.
+ * @param bytes how many bytes of input an operation processes
+ */
+result_t measure (const QString& name, int length, unsigned nLevels, qint64 bytes,
+                  double minSeconds, const std::function <double ()>& op) {
+    using clock = std::chrono::steady_clock;
+    sink = sink + op ();
+
+    const qint64 allocations = nAllocations, allocated = allocatedBytes;
+    qint64 iterations = 0, batch = 1;
+    const auto start = clock::now();
+    std::chrono::duration <double> elapsed (0);
+    while (elapsed.count() < minSeconds) {
+        for (qint64 i = 0; i < batch; ++i)
+            sink = sink + op ();
+        iterations += batch;
+        elapsed = clock::now() - start;
+        if (elapsed.count() < minSeconds / 10)
+            batch *= 2;
+    }
+
+    result_t ans;
+    ans.name = name;
+    ans.length = length;
+    ans.nLevels = nLevels;
+    ans.iterations = iterations;
+    ans.nsPerOp = elapsed.count() * 1e9 / iterations;
+    ans.bytesPerSecond = bytes * iterations / elapsed.count();
+    ans.allocationsPerOp = static_cast <double> (nAllocations - allocations) / iterations;
+    ans.allocatedBytesPerOp = static_cast <double> (allocatedBytes - allocated) / iterations;
+    return ans;
+}
+
+/// A series of the generated sets with the noise of the generation tab
+QVector <float> syntheticSeries (int length) {
+    // all the terms are there, the logistic map is in its chaotic range
+    const QVector <double> k {1., 3., .5, .3, -1., .4, 2., .2, 100., .93};
+    QVector <float> values (length);
+    const double step = 1. / (length - 1);
+    for (int i = 0; i < length; ++i)
+        values[i] = generator::series_generator(k, i * step, length - 1 - i)
+                  + generator::get_error(0., .5);
+    return values;
+}
+
+QJsonObject toJson (const result_t& r) {
+    QJsonObject ans;
+    ans.insert("name", r.name);
+    ans.insert("length", r.length);
+    ans.insert("nLevels", r.nLevels > 0 ? QJsonValue (static_cast <int> (r.nLevels)) : QJsonValue ());
+    ans.insert("iterations", static_cast <double> (r.iterations));
+    ans.insert("nsPerOp", r.nsPerOp);
+    ans.insert("bytesPerSecond", r.bytesPerSecond);
+    ans.insert("allocationsPerOp", r.allocationsPerOp);
+    ans.insert("allocatedBytesPerOp", r.allocatedBytesPerOp);
+    return ans;
+}
+
+QVector <int> parseList (const QString& list, bool& ok) {
+    QVector <int> ans;
+    ok = true;
+    for (const QString& item : list.split(',', QString::SkipEmptyParts)) {
+        // 1e7 is easier to type than 10000000
+        const double v = item.trimmed().toDouble(&ok);
+        if (not ok or v < 2 or v > 2e9) {
+            ok = false;
+            break;
+        }
+        ans.append(static_cast <int> (v));
+    }
+    return ans;
+}
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app (argc, argv);
+    QCoreApplication::setApplicationName("tsanalyzer-bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Measures the TimeSeries metrics and the Kolmogorov estimate one by one on generated series,\n"
+        "and the SeriesBatch ones for as many series at once as the analysis batches.\n"
+        "The results are written as JSON: the time and the input bytes per second of an operation,\n"
+        "the allocations and the allocated bytes per operation.");
+    parser.addHelpOption();
+    const QCommandLineOption
+        lengthsOption ("lengths", "The comma-separated series lengths.", "list", "1e2,1e3,1e4,1e5,1e6,1e7"),
+        levelsOption ("levels", "The comma-separated numbers of levels for the codes.", "list", "4,8,32"),
+        minTimeOption ("min-time", "How many seconds to run each benchmark for at least.", "seconds", "0.5"),
+        filterOption ("filter", "Only run the benchmarks with the names containing the text.", "text"),
+        outputOption ("output", "Write the results to the file rather than to stdout.", "file"),
+        quietOption ("quiet", "Do not report the progress to stderr.");
+    for (const auto& option : {lengthsOption, levelsOption, minTimeOption, filterOption,
+                               outputOption, quietOption})
+        parser.addOption(option);
+    parser.process(app);
+
+    bool ok = true, levelsOk = true, timeOk = true;
+    const QVector <int> lengths = parseList (parser.value(lengthsOption), ok),
+                        levels = parseList (parser.value(levelsOption), levelsOk);
+    const double minTime = parser.value(minTimeOption).toDouble(&timeOk);
+    if (not ok or not levelsOk or not timeOk or minTime <= 0) {
+        QTextStream (stderr) << "tsanalyzer-bench: wrong option, see --help\n";
+        return 64;
+    }
+    const QString filter = parser.value(filterOption);
+    const bool quiet = parser.isSet(quietOption);
+
+    QTemporaryDir tmp;
+    if (not tmp.isValid()) {
+        QTextStream (stderr) << "tsanalyzer-bench: can't create a temporary directory\n";
+        return 73;
+    }
+
+    QJsonArray results;
+    auto run = [&](const QString& name, int length, unsigned nLevels, qint64 bytes,
+                   const std::function <double ()>& op) {
+        if (not filter.isEmpty() and not name.contains(filter))
+            return;
+        const result_t r = measure (name, length, nLevels, bytes, minTime, op);
+        if (not quiet)
+            std::fprintf (stderr, "%-28s n=%-9d levels=%-3u %14.0f ns/op %10.1f MB/s %8.1f allocs/op\n",
+                          qPrintable (r.name), r.length, r.nLevels,
+                          r.nsPerOp, r.bytesPerSecond / 1e6, r.allocationsPerOp);
+        results.append(toJson (r));
+    };
+
+    for (int n : lengths) {
+        const QVector <float> values = syntheticSeries (n);
+        const qint64 valueBytes = n * static_cast <qint64> (sizeof (float));
+
+        // reading: the text format and the mapped binary one
+        const QString textFile = QDir (tmp.path()).filePath("series"),
+                      binaryFile = textFile + ".tsb";
+        {
+            QFile file (textFile);
+            file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate);
+            QTextStream out (&file);
+            for (float v : values)
+                out << v << "\n";
+        }
+        SeriesFile::write(binaryFile, Span <const float> (values.constData(), values.size()));
+        for (const QString& fileName : {textFile, binaryFile}) {
+            const QString name = fileName.endsWith(".tsb") ? "readFile/tsb" : "readFile/text";
+            run (name, n, 0, QFile (fileName).size(), [&fileName]{
+                TimeSeries ts;
+                ts.readFile(fileName);
+                return ts.size();
+            });
+        }
+        QFile::remove(textFile);
+        QFile::remove(binaryFile);
+
+        TimeSeries ts (values);
+        ts.encoded();
+        run ("harmonicComplexity", n, 0, valueBytes, [&ts]{
+            return ts.harmonicComplexity();
+        });
+        for (HurstEstimator method : HurstEngine::estimators()) {
+            run (QString ("herstValue/") + HurstEngine::id(method), n, 0, valueBytes, [&ts, method]{
+                return ts.herstValue(method);
+            });
+        }
+
+        for (int nLevels : levels) {
+            ts.setNLevels(nLevels);
+            ts.encoded();
+            run ("encode", n, nLevels, valueBytes, [&ts, nLevels]{
+                // changing the levels makes the codes dirty
+                ts.setNLevels(nLevels);
+                return ts.encoded().size();
+            });
+            run ("tendencySeries", n, nLevels, valueBytes, [&ts]{
+                return ts.tendencySeries().size();
+            });
+            if (2 * n <= SeriesBatch::maxValues and CodeSpan::widthFor(nLevels) == 1) {
+                // the harmonic complexities and the fractal dimensionalities of as many series
+                // as the engine batches, the bytes are of all of them
+                const int nSeries = std::min (SeriesBatch::maxSeries, SeriesBatch::maxValues / n);
+                SeriesBatch batch (nSeries, n);
+                for (int s = 0; s < nSeries; ++s)
+                    batch.setSeries(s, values.constData());
+                QVector <coordinates_t> coordinates (nSeries);
+                run ("SeriesBatch/fill", n, nLevels, nSeries * valueBytes, [&batch, &coordinates, nLevels]{
+                    // the batch is encoded anew as well
+                    batch.setNLevels(nLevels);
+                    batch.fill(coordinates.data(), SeriesBatch::metrics());
+                    return coordinates[0].by_name.harmonicComplexity;
+                });
+            }
+            run ("symbolicDiversity", n, nLevels, valueBytes, [&ts]{
+                return ts.symbolicDiversity().window;
+            });
+            run ("lempelZivComplexity", n, nLevels, valueBytes, [&ts]{
+                return ts.lempelZivComplexity();
+            });
+
+            const CodeSpan codes = ts.encoded();
+            for (CompressorType type : Compressor::types()) {
+                Compressor& compressor = Compressor::local(type);
+                run (QString ("kolmogorov/") + Compressor::id(type), n, nLevels, codes.byteSize(),
+                     [&compressor, &codes]{
+                    return compressor.compressedSize(codes.data(), codes.byteSize());
+                });
+            }
+        }
+    }
+
+    QJsonObject report;
+    report.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    report.insert("minTime", minTime);
+    report.insert("benchmarks", results);
+    const QByteArray json = QJsonDocument (report).toJson();
+
+    QFile output;
+    if (parser.isSet(outputOption)) {
+        output.setFileName(parser.value(outputOption));
+        ok = output.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    } else {
+        ok = output.open(stdout, QIODevice::WriteOnly);
+    }
+    if (not ok or output.write(json) != json.size()) {
+        QTextStream (stderr) << "tsanalyzer-bench: can't write the results\n";
+        return 74;
+    }
+    return 0;
+}
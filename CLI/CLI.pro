@@ -0,0 +1,17 @@
+#-------------------------------------------------
+#
+# The command line analyzer for the headless nodes
+#
+#-------------------------------------------------
+
+QT       = core
+CONFIG   += console
+CONFIG   -= app_bundle
+
+include(../GUI/Core.pri)
+
+TARGET = tsanalyzer-cli
+TEMPLATE = app
+
+
+SOURCES += main.cc
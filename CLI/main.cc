@@ -0,0 +1,463 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+
+#include "AnalysisEngine.h"
+#include "CoordinatesStore.h"
+#include "Generator.h"
+
+namespace {
+/// The exit codes, the ones of sysexits.h where there are such
+enum exitCode_t {
+    success = 0,
+    /// Some files of the set are not series or could not be analysed, the results are written still
+    someFailed = 1,
+    usageError = 64,
+    noInput = 66,
+    cantCreate = 73,
+    ioError = 74,
+    /// Stopped by SIGINT or SIGTERM, the processed series are kept for the next run
+    interrupted = 130
+};
+
+AnalysisEngine* runningEngine = nullptr;
+volatile std::sig_atomic_t signalled = 0;
+
+extern "C" void onSignal (int) {
+    signalled = 1;
+    if (runningEngine)
+        runningEngine->stop();
+}
+
+/// Latin spellings of the Greek coefficient names
+const char* coefficientAliases[generator::nCoefficients] = {
+    "a", "alpha", "b", "c", "gamma", "d", "delta", "h", "m", "r"
+};
+
+/// The coefficients not given make their terms vanish, or are the usual ones for the logistic map
+const double neutralCoefficients[generator::nCoefficients] = {
+    0., 1., 0., 0., 0., 0., 1., 0., 100., .91
+};
+
+void error (const QString& message) {
+    QTextStream (stderr) << "tsanalyzer-cli: " << message << "\n";
+}
+
+/**
+ * @brief Turn a job file into command line arguments.
+ *
+ * Each line is either a step name, or an option name followed by " = value" if it takes one.
+ * The empty lines and the ones starting with '#' are skipped.
+ * @return false if the file can't be read
+ */
+bool readJob (const QString& fileName, QStringList& arguments) {
+    QFile file (fileName);
+    if (not file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    QTextStream in (&file);
+    while (not in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty() or line.startsWith('#'))
+            continue;
+        const int eq = line.indexOf('=');
+        if (eq < 0) {
+            if (line == "generate" or line == "analyze" or line == "correlate")
+                arguments << line;
+            else
+                arguments << "--" + line;
+        } else {
+            arguments << "--" + line.left(eq).trimmed() << line.mid(eq + 1).trimmed();
+        }
+    }
+    return true;
+}
+
+/// Parse "name=min[:max[:step]]" into the @p ranges
+bool parseCoefficient (const QString& option, QVector <generator::range_t>& ranges) {
+    const int eq = option.indexOf('=');
+    if (eq < 0)
+        return false;
+    const QString name = option.left(eq).trimmed();
+    int index = 0;
+    while (index < generator::nCoefficients
+           and name != QString::fromUtf8(generator::coefficientName(index))
+           and name != QLatin1String (coefficientAliases[index]))
+        ++index;
+    if (index == generator::nCoefficients)
+        return false;
+
+    const QStringList parts = option.mid(eq + 1).split(':');
+    if (parts.size() > 3)
+        return false;
+    bool ok = true;
+    double v[3];
+    for (int i = 0; i < parts.size() and ok; ++i)
+        v[i] = parts[i].toDouble(&ok);
+    if (not ok)
+        return false;
+    generator::range_t& range = ranges[index];
+    range.min = v[0];
+    range.max = parts.size() > 1 ? v[1] : v[0];
+    // any positive step leaves a single value alone
+    range.step = parts.size() > 2 ? v[2] : (range.max > range.min ? range.max - range.min : 1.);
+    return range.step > 0 and range.min <= range.max;
+}
+
+/// Generate the set the way the generation tab does, @return how many series could not be written
+int generateSet (const QDir& setDir, const QVector <generator::range_t>& ranges,
+                 unsigned npoints, double errmean, double errdisp, bool binary) {
+    unsigned id = 0;
+    int nFailed = 0;
+    generator::forAllCoefficients(ranges, [&](const QVector <double>& k){
+        if (signalled)
+            return;
+        const QString fname = setDir.absoluteFilePath("ts_" + QString::number(id++));
+        bool ok = generator::generate_series(
+                      [&k, errmean, errdisp](float step, unsigned index){
+                          return generator::series_generator(k, step, index)
+                               + generator::get_error(errmean, errdisp);
+                      },
+                      npoints, fname, binary, k);
+        if (ok and not binary) {
+            QFile file (fname + ".coeffts");
+            ok = file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate);
+            QTextStream out (&file);
+            for (double v : k)
+                out << v << '\n';
+        }
+        nFailed += not ok;
+    });
+    if (not generator::generate_series([](float, unsigned){return generator::get_error(0., .8);},
+                                       npoints, setDir.absoluteFilePath("ts_const"), binary))
+        ++nFailed;
+    return nFailed;
+}
+
+/// Run the engine on the set, reporting the progress to stderr unless @p quiet
+bool analyseSet (const QString& setPath, const analysisSettings_t& settings, bool quiet,
+                 int& nFailed, QVector <double>& correlations) {
+    AnalysisEngine engine;
+    // the slots are called right in the engine thread, so no event loop is needed
+    auto lastReport = std::chrono::steady_clock::now();
+    QObject::connect(&engine, &AnalysisEngine::processingProgress,
+                     [quiet, &lastReport](int done, int total, double secondsLeft){
+        const auto now = std::chrono::steady_clock::now();
+        if (quiet or (now - lastReport < std::chrono::seconds (1) and done < total))
+            return;
+        lastReport = now;
+        if (secondsLeft == secondsLeft)
+            std::fprintf (stderr, "%d/%d, %.0f s left\n", done, total, secondsLeft);
+        else
+            std::fprintf (stderr, "%d/%d\n", done, total);
+    });
+    QObject::connect(&engine, &AnalysisEngine::correlationsReady,
+                     [&correlations](QVector <double> ans){
+        correlations = ans;
+    });
+    bool completed = false;
+    QObject::connect(&engine, &AnalysisEngine::finished, [&completed](bool ok){
+        completed = ok;
+    });
+
+    runningEngine = &engine;
+    engine.start(setPath, settings);
+    engine.wait();
+    runningEngine = nullptr;
+    nFailed = engine.nFailed();
+    return completed;
+}
+
+/// The requested part of the correlations and the metrics as JSON
+QByteArray report (const QString& setPath, int nSeries, int nFailed,
+                   const analysisSettings_t& settings, const QVector <double>& correlations) {
+    const size_t n = coordinates_t::nValues;
+    QJsonArray metrics, matrix;
+    for (size_t i = 0; i < n; ++i) {
+        if (not settings.metrics[i])
+            continue;
+        metrics.append(QLatin1String (coordinates_t::coordinateId(i)));
+        QJsonArray row;
+        for (size_t j = 0; j < n; ++j)
+            if (settings.metrics[j])
+                row.append(correlations.isEmpty() ? QJsonValue () : QJsonValue (correlations[i * n + j]));
+        matrix.append(row);
+    }
+
+    QJsonObject ans;
+    ans.insert("set", QDir (setPath).absolutePath());
+    ans.insert("series", nSeries);
+    ans.insert("failed", nFailed);
+    ans.insert("metrics", metrics);
+    ans.insert("correlation", QLatin1String (RankCorrelation::id(settings.correlation)));
+    // the non-finite correlations of the constant metrics are null
+    ans.insert("correlations", matrix);
+    return QJsonDocument (ans).toJson();
+}
+}
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app (argc, argv);
+    QCoreApplication::setApplicationName("tsanalyzer-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Generates a set of time series, computes their metrics and the correlations of them.\n"
+        "The steps are run in the order generate, analyze, correlate, whatever order they are given in;\n"
+        "analyze implies correlate. The results are written as JSON.\n"
+        "Exit codes: 0 success, 1 some files were not analysed, 64 wrong usage, 66 no set,\n"
+        "73 the output can't be created, 74 I/O error, 130 interrupted.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("steps", "generate, analyze and/or correlate", "[steps...]");
+
+    const QCommandLineOption
+        jobOption ("job", "Read the options and the steps from the job file, one per line, "
+                          "\"option = value\" or a step name.", "file"),
+        setOption ("set", "The directory of the set.", "dir"),
+        outputOption ("output", "Write the results to the file rather than to stdout.", "file"),
+        quietOption ("quiet", "Do not report the progress to stderr."),
+        valuesOption ("values", "generate: how many values each series has.", "n", "1500"),
+        coefficientOption ("coefficient", "generate: the range of a coefficient, e.g. alpha=0.1:2:0.5; "
+                                          "the ones not given make their terms vanish.",
+                           "name=min[:max[:step]]"),
+        errorOption ("error", "generate: the mean and the dispersion of the random error.",
+                     "mean:dispersion", "0:0.5"),
+        binaryOption ("binary", "generate: write .tsb files rather than text."),
+        segmentsOption ("segments", "analyze: the number of half-segments of the values domain.", "n", "8"),
+        hurstOption ("hurst", "analyze: the Hurst estimator, whole, rs, dfa1, dfa2 or haar.", "name", "whole"),
+        windowOption ("window", "analyze: the sliding window for the trajectories, 0 for none.", "n", "0"),
+        hopOption ("hop", "analyze: the hop of the sliding window.", "n", "100"),
+        entropyOption ("entropy", "analyze: write the block entropy curves to .entropy files."),
+        compressorsOption ("compressors", "analyze: the comma-separated compressors for Kolmogorov "
+                                          "complexity, of lzma, deflate, lz77, ppm; the first one "
+                                          "gives the metric.", "list", "lzma"),
+        levelOption ("level", "analyze: the compression level, 0-9.", "n", "6"),
+        extremeOption ("extreme", "analyze: the slowest compression settings."),
+        threadsOption ("threads", "analyze: the number of worker threads, 0 for one per core.", "n", "0"),
+        metricsOption ("metrics", "analyze, correlate: the comma-separated metrics to compute "
+                                  "and to correlate, all of them by default.", "list"),
+        correlationOption ("correlation", "analyze, correlate: the correlations, pearson, spearman "
+                                          "or kendall.", "name", "pearson");
+    for (const auto& option : {jobOption, setOption, outputOption, quietOption,
+                               valuesOption, coefficientOption, errorOption, binaryOption,
+                               segmentsOption, hurstOption, windowOption, hopOption, entropyOption,
+                               compressorsOption, levelOption, extremeOption, threadsOption,
+                               metricsOption, correlationOption})
+        parser.addOption(option);
+
+    QStringList arguments = QCoreApplication::arguments();
+    for (int i = 1; i + 1 < arguments.size(); ++i) {
+        if (arguments[i] == "--job") {
+            QStringList job;
+            if (not readJob (arguments[i + 1], job)) {
+                error (QString ("can't read the job file %1").arg(arguments[i + 1]));
+                return noInput;
+            }
+            // the command line overrides the job file
+            arguments = arguments.mid(0, 1) + job + arguments.mid(1);
+            break;
+        }
+    }
+    if (not parser.parse(arguments)) {
+        error (parser.errorText());
+        return usageError;
+    }
+    if (parser.isSet("help")) {
+        QTextStream (stdout) << parser.helpText();
+        return success;
+    }
+
+    const QStringList steps = parser.positionalArguments();
+    for (const QString& step : steps) {
+        if (step != "generate" and step != "analyze" and step != "correlate") {
+            error (QString ("unknown step %1").arg(step));
+            return usageError;
+        }
+    }
+    const bool generate = steps.contains("generate"),
+               analyse = steps.contains("analyze"),
+               correlate = analyse or steps.contains("correlate");
+    if (steps.isEmpty() or not parser.isSet(setOption)) {
+        error ("both the set and some steps are needed, see --help");
+        return usageError;
+    }
+    const QString setPath = parser.value(setOption);
+    const bool quiet = parser.isSet(quietOption);
+
+    std::signal (SIGINT, onSignal);
+    std::signal (SIGTERM, onSignal);
+
+    bool ok = true;
+    analysisSettings_t settings;
+    settings.nSegments = parser.value(segmentsOption).toUInt(&ok);
+    ok = ok and settings.nSegments > 0;
+    settings.slidingWindow = ok ? parser.value(windowOption).toInt(&ok) : 0;
+    settings.slidingHop = ok ? parser.value(hopOption).toInt(&ok) : 0;
+    settings.compression.level = ok ? parser.value(levelOption).toInt(&ok) : 0;
+    settings.compression.extreme = parser.isSet(extremeOption);
+    settings.entropyCurves = parser.isSet(entropyOption);
+    settings.nThreads = ok ? parser.value(threadsOption).toInt(&ok) : 0;
+    ok = ok and settings.slidingWindow >= 0 and settings.slidingHop > 0
+            and 0 <= settings.compression.level and settings.compression.level <= 9
+            and settings.nThreads >= 0;
+    if (not ok) {
+        error ("wrong numeric option, see --help");
+        return usageError;
+    }
+
+    const QString hurst = parser.value(hurstOption);
+    bool known = false;
+    for (HurstEstimator method : HurstEngine::estimators()) {
+        if (hurst == QLatin1String (HurstEngine::id(method))) {
+            settings.herstEstimator = method;
+            known = true;
+        }
+    }
+    if (not known) {
+        error (QString ("unknown Hurst estimator %1").arg(hurst));
+        return usageError;
+    }
+
+    for (const QString& id : parser.value(compressorsOption).split(',', QString::SkipEmptyParts)) {
+        known = false;
+        for (CompressorType type : Compressor::types()) {
+            if (id.trimmed() == QLatin1String (Compressor::id(type))) {
+                settings.compression.types.append(type);
+                known = true;
+            }
+        }
+        if (not known) {
+            error (QString ("unknown compressor %1").arg(id));
+            return usageError;
+        }
+    }
+    if (settings.compression.types.isEmpty()) {
+        error ("at least one compressor is needed");
+        return usageError;
+    }
+
+    const QString correlation = parser.value(correlationOption);
+    known = false;
+    for (CorrelationMethod method : RankCorrelation::methods()) {
+        if (correlation == QLatin1String (RankCorrelation::id(method))) {
+            settings.correlation = method;
+            known = true;
+        }
+    }
+    if (not known) {
+        error (QString ("unknown correlation %1").arg(correlation));
+        return usageError;
+    }
+
+    if (parser.isSet(metricsOption)) {
+        settings.metrics.reset();
+        for (const QString& id : parser.value(metricsOption).split(',', QString::SkipEmptyParts)) {
+            const size_t index = coordinates_t::coordinateIndex(id.trimmed());
+            if (index == coordinates_t::nValues) {
+                error (QString ("unknown metric %1").arg(id));
+                return usageError;
+            }
+            settings.metrics.set(index);
+        }
+        if (settings.metrics.none()) {
+            error ("at least one metric is needed");
+            return usageError;
+        }
+    }
+
+    int nFailed = 0;
+    if (generate) {
+        QVector <generator::range_t> ranges (generator::nCoefficients);
+        for (int i = 0; i < generator::nCoefficients; ++i)
+            ranges[i] = generator::range_t {neutralCoefficients[i], neutralCoefficients[i], 1.};
+        for (const QString& option : parser.values(coefficientOption)) {
+            if (not parseCoefficient (option, ranges)) {
+                error (QString ("wrong coefficient %1").arg(option));
+                return usageError;
+            }
+        }
+        const QStringList errorParts = parser.value(errorOption).split(':');
+        bool meanOk = false, dispOk = false;
+        const double errmean = errorParts.value(0).toDouble(&meanOk),
+                     errdisp = errorParts.value(1).toDouble(&dispOk);
+        const unsigned npoints = parser.value(valuesOption).toUInt(&ok);
+        if (errorParts.size() != 2 or not meanOk or not dispOk or errdisp < 0) {
+            error ("the error must be given as mean:dispersion");
+            return usageError;
+        }
+        if (not ok or npoints < 2) {
+            error ("a series must have at least 2 values");
+            return usageError;
+        }
+
+        QDir setDir (setPath);
+        if (not setDir.mkpath(".")) {
+            error (QString ("can't create the set directory %1").arg(setPath));
+            return cantCreate;
+        }
+        if (not quiet)
+            std::fprintf (stderr, "generating %u series\n", generator::setSize(ranges) + 1);
+        if (generateSet (setDir, ranges, npoints, errmean, errdisp, parser.isSet(binaryOption)) > 0) {
+            error ("some series could not be written");
+            return ioError;
+        }
+        if (signalled)
+            return interrupted;
+    }
+
+    if (not QDir (setPath).exists()) {
+        error (QString ("no set in %1").arg(setPath));
+        return noInput;
+    }
+
+    if (not correlate)
+        return success;
+
+    QVector <double> correlations;
+    const QDir destDir (AnalysisEngine::destPath(setPath));
+    if (analyse) {
+        if (not analyseSet (setPath, settings, quiet, nFailed, correlations))
+            return interrupted;
+    } else {
+        if (not destDir.exists()) {
+            error (QString ("the set %1 has not been analysed").arg(setPath));
+            return noInput;
+        }
+        if (not CoordinatesStore::importCoords(destDir)) {
+            error (QString ("can't import the .coords files of %1").arg(setPath));
+            return cantCreate;
+        }
+    }
+    const CoordinatesStore store (CoordinatesStore::path(destDir));
+    if (not store.isValid()) {
+        error (QString ("can't read the coordinates of %1").arg(setPath));
+        return ioError;
+    }
+    if (not analyse)
+        correlations = AnalysisEngine::correlations(destDir, settings.correlation, settings.nThreads);
+    const int nSeries = store.nLiveRows();
+
+    const QByteArray json = report (setPath, nSeries, nFailed, settings, correlations);
+    if (parser.isSet(outputOption)) {
+        QFile output (parser.value(outputOption));
+        if (not output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            error (QString ("can't create %1").arg(output.fileName()));
+            return cantCreate;
+        }
+        if (output.write(json) != json.size())
+            return ioError;
+    } else {
+        QFile output;
+        if (not output.open(stdout, QIODevice::WriteOnly) or output.write(json) != json.size())
+            return ioError;
+    }
+    return nFailed > 0 ? someFailed : success;
+}
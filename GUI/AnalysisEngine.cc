@@ -0,0 +1,647 @@
+#include "AnalysisEngine.h"
+#include "CoMoments.h"
+#include "CoordinatesStore.h"
+#include "Manifest.h"
+#include "MetricCache.h"
+#include "MpscQueue.h"
+#include "SeriesBatch.h"
+#include "SlidingAnalysis.h"
+#include "TaskPool.h"
+#include "TimeSeries.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <queue>
+
+#include <QDebug>
+#include <QFile>
+#include <QDateTime>
+#include <QHash>
+#include <QFileInfo>
+#include <QTextStream>
+
+AnalysisEngine::AnalysisEngine(QObject* parent)
+    : QObject (parent) {
+    qRegisterMetaType <QVector <double>> ("QVector<double>");
+}
+
+AnalysisEngine::~AnalysisEngine() {
+    stop();
+    wait();
+}
+
+bool AnalysisEngine::start(const QString& setPath, const analysisSettings_t& settings) {
+    if (_Running)
+        return false;
+    if (_Thread.joinable())
+        _Thread.join();
+    _Stop = false;
+    _Failed = 0;
+    _Running = true;
+    _Thread = std::thread (&AnalysisEngine::_Run, this, setPath, settings);
+    return true;
+}
+
+void AnalysisEngine::wait() {
+    if (_Thread.joinable())
+        _Thread.join();
+}
+
+QString AnalysisEngine::destPath(const QString& setPath) {
+    return QDir(setPath).filePath("processed");
+}
+
+QStringList AnalysisEngine::seriesList(const QDir& dir) {
+    QStringList lst = dir.entryList(QDir::Readable | QDir::Files);
+    for (auto i = lst.begin(); i != lst.end();) {
+        if (i->toLower().endsWith(".coeffts"))
+            i = lst.erase(i);
+        else
+            ++i;
+    }
+    return lst;
+}
+
+QString AnalysisEngine::parameters(const analysisSettings_t& settings) {
+    QStringList compressors;
+    for (CompressorType type : settings.compression.types)
+        compressors.append(Compressor::id(type));
+    return QString ("segments=%1 hurst=%2 compressors=%3 level=%4 extreme=%5 window=%6 hop=%7")
+           .arg(settings.nSegments)
+           .arg(HurstEngine::id(settings.herstEstimator))
+           .arg(compressors.join(','))
+           .arg(settings.compression.level)
+           .arg(settings.compression.extreme ? 1 : 0)
+           .arg(settings.slidingWindow)
+           .arg(settings.slidingWindow > 0 ? settings.slidingHop : 0)
+           + (settings.entropyCurves ? " entropy=1" : "");
+}
+
+QString AnalysisEngine::metricParameters(size_t coordinate, const analysisSettings_t& settings) {
+    const coordinates_t c {};
+    const auto& v = c.by_name;
+    const double* value = c.values + coordinate;
+    // the raw series alone
+    if (value == &v.harmonicComplexity)
+        return QString ();
+    const QString hurst = QString ("hurst=%1").arg(HurstEngine::id(settings.herstEstimator));
+    if (value == &v.fractalDimensionality)
+        return hurst;
+    // the rest is of the codes, the tendency series included
+    const QString segments = QString ("segments=%1").arg(settings.nSegments);
+    if (value == &v.tendencyFractalDimensionality)
+        return segments + " " + hurst;
+    if (value == &v.KolmogorovComplexity or value == &v.tendencyKolmogorovComplexity) {
+        const compression_t& compression = settings.compression;
+        return segments + QString (" compressor=%1 level=%2 extreme=%3")
+               .arg(compression.types.isEmpty() ? "none" : Compressor::id(compression.types.first()))
+               .arg(compression.level)
+               .arg(compression.extreme ? 1 : 0);
+    }
+    return segments;
+}
+
+void AnalysisEngine::_Run(QString setPath, analysisSettings_t settings) {
+    const QDir dir (setPath);
+    const QDir destDir (destPath(setPath));
+    destDir.mkdir(destDir.absolutePath());
+    const QString storePath = CoordinatesStore::path(destDir);
+    if (not CoordinatesStore::importCoords(destDir))
+        qDebug () << "!!! can't import the .coords files into" << storePath;
+    Manifest manifest (Manifest::path(destDir));
+    MetricCache cache (MetricCache::path(destDir));
+    const QString parameters = AnalysisEngine::parameters(settings);
+
+    // what has been computed already
+    QHash <QString, coordinates_t> known;
+    const QString momentsPath = CoMoments::path(destDir);
+    CoMoments moments;
+    {
+        const CoordinatesStore store (storePath);
+        for (int b = 0; b < store.nBlocks(); ++b)
+            for (int r = 0; r < store.blockRows(b); ++r)
+                if (store.isLive(b, r))
+                    known.insert(store.name(b, r), store.coordinates(b, r));
+        if (not moments.read(momentsPath, storePath))
+            moments.add(store);
+    }
+
+    // one stat per series, the manifest tells the rest
+    struct series_t {
+        QString fname;
+        Manifest::entry_t seen;
+        /// The entry of the previous runs, if any
+        bool known;
+        Manifest::entry_t previous;
+    };
+    QVector <series_t> lst;
+    for (const QString& fname : seriesList(dir)) {
+        const QFileInfo info (dir, fname);
+        series_t series {fname, Manifest::entry_t (), false, Manifest::entry_t ()};
+        series.seen.size = info.size();
+        series.seen.modified = info.lastModified().toMSecsSinceEpoch();
+        if (const Manifest::entry_t* e = manifest.find(fname)) {
+            if (e->sameStat(series.seen.size, series.seen.modified)) {
+                if (e->status == Manifest::Status::failed and e->parameters == parameters) {
+                    ++_Failed;
+                    continue;
+                }
+                if (e->status == Manifest::Status::done and e->covers(parameters, settings.metrics)
+                    and known.contains(fname))
+                    continue;
+            }
+            series.known = true;
+            series.previous = *e;
+        }
+        lst.append(series);
+    }
+    const int N = lst.size();
+
+#ifdef QT_DEBUG
+    const int nThreads = 1;
+#else
+    const int nThreads = settings.nThreads > 0 ? settings.nThreads
+                                               : static_cast <int> (std::thread::hardware_concurrency());
+#endif
+    const int nWorkers = std::max (1, nThreads);
+    // The series go to the workers by groups, so that the short ones of the same length
+    // are analysed by a SeriesBatch, while there are still enough groups to balance the load
+    const int groupSize = std::max (1, std::min (SeriesBatch::maxSeries, N / (nWorkers * 8)));
+    const int nGroups = (N + groupSize - 1) / groupSize;
+    // the work on a series is about proportional to its size
+    QVector <qint64> costs (nGroups, 0);
+    for (int i = 0; i < N; ++i)
+        costs[i / groupSize] += lst[i].seen.size;
+    struct done_t {
+        QString fname;
+        Manifest::entry_t entry;
+        /// Whether the coordinates have been computed, not just the file found unchanged
+        bool computed;
+        coordinates_t coordinates;
+    };
+    MpscQueue <done_t> done;
+    std::atomic <int> nDone {0};
+    // each worker folds the rows it adds and the ones they supersede into its own accumulators
+    QVector <CoMoments> added (nWorkers), superseded (nWorkers);
+    bool appended = true;
+    // the results wait for the commit, which appends them to the store as a single block
+    // and then tells the manifest about them, so that the blocks stay few on a long run
+    CoordinatesStore::Appender store (storePath);
+    QVector <CoordinatesStore::row_t> rows;
+    QVector <done_t> results;
+    auto lastCommit = std::chrono::steady_clock::now();
+    auto flush = [&](bool commit){
+        done_t result;
+        while (done.pop(result)) {
+            if (result.computed)
+                rows.append(CoordinatesStore::row_t {result.fname, result.coordinates});
+            results.append(std::move (result));
+        }
+        // a commit appends the changes and only now and then rewrites the whole of a huge set,
+        // a crash costs a few seconds of work at most
+        const auto now = std::chrono::steady_clock::now();
+        if (not commit and now - lastCommit <= std::chrono::seconds (5))
+            return;
+        lastCommit = now;
+        if (store.append(rows)) {
+            for (const done_t& r : results)
+                manifest.set(r.fname, r.entry);
+            if (manifest.isDirty()) {
+                if (not cache.commit())
+                    qDebug () << "!!! can't write" << MetricCache::path(destDir);
+                if (not manifest.commit())
+                    qDebug () << "!!! can't write" << Manifest::path(destDir);
+            }
+        } else {
+            qDebug () << "!!! can't append" << rows.size() << "rows to" << storePath;
+            appended = false;
+        }
+        rows.clear();
+        results.clear();
+    };
+
+    // a series from the moment a worker takes it to its result
+    struct job_t {
+        const series_t* series;
+        done_t result;
+        /// What is to be computed, the rest is known already
+        analysisSettings_t missing;
+        /// The coordinates in the store, if any
+        const coordinates_t* old;
+        TimeSeries ts;
+    };
+    auto push = [&done, &nDone](done_t&& result){
+        done.push(std::move (result));
+        ++nDone;
+    };
+    auto needed = [](const analysisSettings_t& missing){
+        return missing.metrics.any() or missing.slidingWindow > 0 or missing.entropyCurves;
+    };
+    // false if the series is unchanged and has been done with
+    auto prepare = [&](int i, job_t& job){
+        const series_t& series = lst[i];
+        job.series = &series;
+        done_t& result = job.result;
+        result = done_t {series.fname, series.seen, true, coordinates_t ()};
+        const Manifest::entry_t& previous = series.previous;
+        // the content of a file not touched since is known
+        result.entry.hash = series.known and previous.sameStat(series.seen.size, series.seen.modified)
+                          ? previous.hash : Manifest::contentHash(dir.absoluteFilePath(series.fname));
+        result.entry.parameters = parameters;
+        const auto old = known.constFind(series.fname);
+        job.old = old != known.constEnd() ? &*old : nullptr;
+
+        const bool unchanged = series.known and previous.hash == result.entry.hash
+            and (previous.status == Manifest::Status::done
+                 ? job.old and previous.covers(parameters, settings.metrics)
+                 : previous.parameters == parameters);
+        if (unchanged) {
+            // only touched
+            result.entry = previous;
+            result.entry.size = series.seen.size;
+            result.entry.modified = series.seen.modified;
+            result.computed = false;
+            if (result.entry.status == Manifest::Status::failed)
+                ++_Failed;
+            push (std::move (result));
+            return false;
+        }
+        // the metrics known for these parameters are taken from the cache, the rest is computed
+        const QByteArray& hash = result.entry.hash;
+        const double nan = std::numeric_limits <double>::quiet_NaN();
+        std::fill (std::begin (result.coordinates.values), std::end (result.coordinates.values), nan);
+        analysisSettings_t& missing = job.missing;
+        missing = settings;
+        for (size_t j = 0; j < coordinates_t::nValues; ++j)
+            if (settings.metrics[j]
+                and cache.find(hash, j, metricParameters (j, settings), result.coordinates.values[j]))
+                missing.metrics[j] = false;
+        // the trajectory and the compressors comparison are only written again if they may differ
+        const bool sameOutput = series.known and previous.status == Manifest::Status::done
+                            and previous.hash == hash and previous.parameters == parameters;
+        if (sameOutput) {
+            missing.slidingWindow = 0;
+            missing.entropyCurves = false;
+        }
+        const auto& v = result.coordinates.by_name;
+        const size_t kolmogorov = &v.KolmogorovComplexity - result.coordinates.values,
+                     tendencyKolmogorov = &v.tendencyKolmogorovComplexity - result.coordinates.values;
+        if (not sameOutput and settings.compression.types.size() > 1) {
+            missing.metrics[kolmogorov] = settings.metrics[kolmogorov];
+            missing.metrics[tendencyKolmogorov] = settings.metrics[tendencyKolmogorov];
+        }
+        return true;
+    };
+    auto fail = [&](job_t& job){
+        ++_Failed;
+        job.result.entry.status = Manifest::Status::failed;
+        job.result.computed = false;
+        push (std::move (job.result));
+        job.ts = TimeSeries ();
+    };
+    // the missing metrics come from the computed ones
+    auto finish = [&](job_t& job, const coordinates_t& computed){
+        done_t& result = job.result;
+        const QByteArray& hash = result.entry.hash;
+        for (size_t j = 0; j < coordinates_t::nValues; ++j) {
+            if (not job.missing.metrics[j])
+                continue;
+            result.coordinates.values[j] = computed.values[j];
+            cache.insert(hash, j, metricParameters (j, settings), computed.values[j]);
+        }
+        result.entry.metrics = settings.metrics;
+
+        // the metrics not requested this time are kept if they are of the same parameters;
+        // the rows stored before the manifest was there, e.g. imported from the .coords files,
+        // may be of other parameters, of the older encoding or of the older content,
+        // so they are computed again as the new ones are
+        const bool sameParameters = job.old and job.series->known
+                                and job.series->previous.parameters == parameters;
+        for (size_t j = 0; j < coordinates_t::nValues; ++j) {
+            if (settings.metrics[j])
+                continue;
+            if (sameParameters and job.series->previous.metrics[j]) {
+                result.coordinates.values[j] = job.old->values[j];
+                result.entry.metrics[j] = true;
+            } else if (cache.find(hash, j, metricParameters (j, settings), result.coordinates.values[j])) {
+                result.entry.metrics[j] = true;
+            }
+        }
+        const int worker = TaskPool::workerId();
+        added[worker].add(result.coordinates);
+        if (job.old)
+            superseded[worker].add(*job.old);
+        push (std::move (result));
+        job.ts = TimeSeries ();
+    };
+    auto analyse = [&](job_t& job){
+        coordinates_t computed;
+        if (processSeries (destDir, job.result.fname, job.ts, job.missing, computed))
+            finish (job, computed);
+        else
+            fail (job);
+    };
+    // The metrics of SeriesBatch for the series of the same length at once,
+    // then the rest of them, the trajectories and the entropy curves one by one
+    // with the codes of the batch
+    const auto batchMetrics = SeriesBatch::metrics();
+    auto analyseBatch = [&](std::vector <job_t>& jobs, const std::vector <int>& lanes){
+        const int K = lanes.size();
+        SeriesBatch batch (K, jobs[lanes[0]].ts.size());
+        batch.setNLevels(settings.nSegments);
+        std::bitset <coordinates_t::nValues> wanted;
+        for (int s = 0; s < K; ++s) {
+            const job_t& job = jobs[lanes[s]];
+            batch.setSeries(s, job.ts.values().data());
+            wanted |= job.missing.metrics;
+        }
+        QVector <coordinates_t> batched (K);
+        batch.fill(batched.data(), wanted & batchMetrics, settings.herstEstimator);
+
+        for (int s = 0; s < K; ++s) {
+            job_t& job = jobs[lanes[s]];
+            batch.shareEncoding(s, job.ts);
+            analysisSettings_t rest = job.missing;
+            rest.metrics &= ~batchMetrics;
+            coordinates_t computed;
+            if (needed (rest) and not processSeries (destDir, job.result.fname, job.ts, rest, computed)) {
+                fail (job);
+                continue;
+            }
+            for (size_t j = 0; j < coordinates_t::nValues; ++j)
+                if (batchMetrics[j])
+                    computed.values[j] = batched[s].values[j];
+            finish (job, computed);
+        }
+    };
+    {
+        TaskPool pool (costs, [&](int group){
+            const int begin = group * groupSize,
+                      end = std::min (N, begin + groupSize);
+            std::vector <job_t> jobs;
+            jobs.reserve(end - begin);
+            // the short series wait for the others of the same length in the group
+            std::map <int, std::vector <int>> lengths;
+            for (int i = begin; i < end and not _Stop; ++i) {
+                job_t job;
+                if (not prepare (i, job))
+                    continue;
+                if (not needed (job.missing)) {
+                    finish (job, coordinates_t ());
+                    continue;
+                }
+                job.ts.setNLevels(settings.nSegments);
+                job.ts.readFile(dir.absoluteFilePath(job.result.fname));
+                const int n = job.ts.size();
+                if (CodeSpan::widthFor(settings.nSegments) == 1 and n >= 2
+                    and 2 * n <= SeriesBatch::maxValues and (job.missing.metrics & batchMetrics).any()) {
+                    lengths[n].push_back(jobs.size());
+                    jobs.push_back(std::move (job));
+                } else {
+                    analyse (job);
+                }
+            }
+            for (const auto& length : lengths) {
+                const std::vector <int>& lanes = length.second;
+                const int nLanes = std::min (SeriesBatch::maxSeries, SeriesBatch::maxValues / length.first);
+                for (size_t first = 0; first < lanes.size(); first += nLanes) {
+                    const std::vector <int> chunk (lanes.begin() + first,
+                                                   lanes.begin() + std::min (lanes.size(), first + nLanes));
+                    if (chunk.size() > 1)
+                        analyseBatch (jobs, chunk);
+                    else
+                        analyse (jobs[chunk[0]]);
+                }
+            }
+        }, nThreads, &_Stop);
+
+        // the time left is estimated by the costs done over the last few seconds
+        struct sample_t {
+            std::chrono::steady_clock::time_point time;
+            qint64 cost;
+        };
+        std::queue <sample_t> samples;
+        const size_t qsize = 50;
+        while (not pool.wait(100)) {
+            flush (false);
+            const auto now = std::chrono::steady_clock::now();
+            const qint64 doneCost = pool.doneCost();
+            samples.push(sample_t {now, doneCost});
+            if (samples.size() > qsize)
+                samples.pop();
+
+            const sample_t& start = samples.front();
+            double secondsLeft = std::numeric_limits <double>::quiet_NaN();
+            if (doneCost > start.cost) {
+                const std::chrono::duration <double> qtime = now - start.time;
+                secondsLeft = qtime.count() * (pool.totalCost() - doneCost) / (doneCost - start.cost);
+            }
+            emit processingProgress(nDone, N, secondsLeft);
+        }
+        emit processingProgress(nDone, N, 0.);
+    }
+    // a stopped run is committed as well, so the next one starts where this one stopped
+    flush (true);
+    store.close();
+    // the values of the old contents of the series changed since are of no use any more
+    if (cache.evict(manifest.hashes()) > 0 and not cache.commit())
+        qDebug () << "!!! can't write" << MetricCache::path(destDir);
+    // the blocks of the commits make a single one for the readers
+    if (not CoordinatesStore::compact(storePath))
+        qDebug () << "!!! can't compact" << storePath;
+
+    CoMoments removed;
+    for (int i = 0; i < nWorkers; ++i) {
+        moments.merge(added[i]);
+        removed.merge(superseded[i]);
+    }
+    moments.remove(removed);
+    // the accumulator stands for the rows in the store only if they all went there
+    if (not appended) {
+        QFile::remove(momentsPath);
+        moments = CoMoments ();
+        moments.add(CoordinatesStore (storePath));
+    } else if (not moments.write(momentsPath, storePath)) {
+        qDebug () << "!!! can't write" << momentsPath;
+    }
+
+    if (not _Stop) {
+        emit correlationsStarted();
+        if (settings.correlation == CorrelationMethod::pearson)
+            emit correlationsReady(moments.correlations());
+        else
+            emit correlationsReady(RankCorrelation (CoordinatesStore (storePath), nThreads)
+                                   .correlations(settings.correlation));
+    }
+    _Running = false;
+    emit finished(not _Stop);
+}
+
+bool AnalysisEngine::processSeries(const QDir& destDir, const QDir& dir, const QString& fname,
+                                   const analysisSettings_t& settings, coordinates_t& coordinates) {
+    TimeSeries ts;
+    ts.setNLevels(settings.nSegments);
+    ts.readFile(dir.absoluteFilePath(fname));
+    return processSeries (destDir, fname, ts, settings, coordinates);
+}
+
+bool AnalysisEngine::processSeries(const QDir& destDir, const QString& fname, const TimeSeries& ts,
+                                   const analysisSettings_t& settings, coordinates_t& coordinates) {
+    if (ts.size() < 2)
+        // must have been some wrong file, not a time series
+        return false;
+
+    const double nan = std::numeric_limits <double>::quiet_NaN();
+    coordinates_t& c = coordinates;
+    std::fill (std::begin (c.values), std::end (c.values), nan);
+    auto& v = c.by_name;
+    const auto wanted = [&settings, &c](const double& coordinate) {
+        return settings.metrics[&coordinate - c.values];
+    };
+
+    const bool needTendency = wanted (v.tendencyHarmonicComplexity)
+                           or wanted (v.tendencyFractalDimensionality)
+                           or wanted (v.tendencySymbolicDiversityWindow)
+                           or wanted (v.tendencySymbolicDiversityDiff)
+                           or wanted (v.tendencyKolmogorovComplexity)
+                           or wanted (v.tendencyLempelZivComplexity)
+                           or settings.entropyCurves;
+    const TimeSeries tendency_ts = needTendency ? ts.tendencySeries() : TimeSeries ();
+
+    if (wanted (v.harmonicComplexity))
+        v.harmonicComplexity = ts.harmonicComplexity();
+    if (wanted (v.tendencyHarmonicComplexity))
+        v.tendencyHarmonicComplexity = tendency_ts.harmonicComplexity();
+
+    if (wanted (v.fractalDimensionality))
+        v.fractalDimensionality = ts.fractalDimensionality(settings.herstEstimator);
+    if (wanted (v.tendencyFractalDimensionality))
+        v.tendencyFractalDimensionality = tendency_ts.fractalDimensionality(settings.herstEstimator);
+
+    TimeSeries::blockEntropy_t entropy, tendencyEntropy;
+    if (settings.entropyCurves) {
+        // the curves of all the word lengths, the diversities come with them however long the words go
+        entropy = ts.blockEntropy();
+        tendencyEntropy = tendency_ts.blockEntropy();
+        if (not writeEntropy (destDir.absoluteFilePath(fname + ".entropy"), entropy, tendencyEntropy)) {
+            qDebug () << "!!! can't write" << fname + ".entropy";
+            return false;
+        }
+    }
+
+    // the window and the difference come together
+    if (settings.entropyCurves) {
+        if (wanted (v.symbolicDiversityWindow) or wanted (v.symbolicDiversityDiff)) {
+            v.symbolicDiversityWindow = entropy.diversity.window;
+            v.symbolicDiversityDiff = entropy.diversity.maxdiff;
+        }
+        if (wanted (v.tendencySymbolicDiversityWindow) or wanted (v.tendencySymbolicDiversityDiff)) {
+            v.tendencySymbolicDiversityWindow = tendencyEntropy.diversity.window;
+            v.tendencySymbolicDiversityDiff = tendencyEntropy.diversity.maxdiff;
+        }
+    } else if (wanted (v.symbolicDiversityWindow) or wanted (v.symbolicDiversityDiff)) {
+        auto diversity = ts.symbolicDiversity();
+        v.symbolicDiversityWindow = diversity.window;
+        v.symbolicDiversityDiff = diversity.maxdiff;
+    }
+    if (not settings.entropyCurves
+        and (wanted (v.tendencySymbolicDiversityWindow) or wanted (v.tendencySymbolicDiversityDiff))) {
+        auto tendency_diversity = tendency_ts.symbolicDiversity();
+        v.tendencySymbolicDiversityWindow = tendency_diversity.window;
+        v.tendencySymbolicDiversityDiff = tendency_diversity.maxdiff;
+    }
+
+    if (settings.slidingWindow > 0) {
+        const SlidingAnalysis sliding (ts, settings.slidingWindow, settings.slidingHop,
+                                       settings.herstEstimator);
+        if (not sliding.write(destDir.absoluteFilePath(fname + ".trajectory"), sliding.trajectory())) {
+            qDebug () << "!!! can't write" << fname + ".trajectory";
+            return false;
+        }
+    }
+
+    const compression_t& compression = settings.compression;
+    const bool wantedPlain = wanted (v.KolmogorovComplexity),
+               wantedTendency = wanted (v.tendencyKolmogorovComplexity);
+    if (wantedPlain or wantedTendency) {
+        // the codes are compressed as they are in memory, the tendency one byte per value;
+        // either of them is only compressed if wanted, the other one stays NaN
+        QVector <int8_t> tendency;
+        if (wantedTendency) {
+            const auto tendencyValues = tendency_ts.values();
+            tendency.resize(tendencyValues.size());
+            std::copy (tendencyValues.begin(), tendencyValues.end(), tendency.begin());
+        }
+
+        QVector <double> complexity, t_complexity;
+        for (CompressorType type : compression.types) {
+            Compressor& compressor = Compressor::local(type, compression.level, compression.extreme);
+            double plainValue = nan, tendencyValue = nan;
+            if (wantedPlain) {
+                const auto coded = ts.encoded();
+                const qint64 compressed = compressor.compressedSize(coded.data(), coded.byteSize());
+                if (compressed <= 0) {
+                    qDebug () << "!!!" << Compressor::name(type) << "compression failed, something is wrong!";
+                    return false;
+                }
+                plainValue = 1. / (static_cast <double> (coded.byteSize()) / compressed - 1);
+            }
+            if (wantedTendency) {
+                const qint64 t_compressed = compressor.compressedSize(tendency.constData(), tendency.size());
+                if (t_compressed <= 0) {
+                    qDebug () << "!!!" << Compressor::name(type) << "compression failed, something is wrong!";
+                    return false;
+                }
+                tendencyValue = 1. / (static_cast <double> (tendency.size()) / t_compressed - 1);
+            }
+            complexity.append(plainValue);
+            t_complexity.append(tendencyValue);
+        }
+        v.KolmogorovComplexity = complexity.value(0, nan);
+        v.tendencyKolmogorovComplexity = t_complexity.value(0, nan);
+
+        if (compression.types.size() > 1) {
+            QFile comparisonFile (destDir.absoluteFilePath(fname + ".compression"));
+            comparisonFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+            QTextStream comparison (&comparisonFile);
+            for (int i = 0; i < compression.types.size(); ++i)
+                comparison << QString::fromUtf8(Compressor::name(compression.types[i])) << "\t"
+                           << complexity[i] << "\t" << t_complexity[i] << "\n";
+        }
+    }
+
+    if (wanted (v.LempelZivComplexity))
+        v.LempelZivComplexity = ts.lempelZivComplexity();
+    if (wanted (v.tendencyLempelZivComplexity))
+        v.tendencyLempelZivComplexity = tendency_ts.lempelZivComplexity();
+
+    return true;
+}
+
+bool AnalysisEngine::writeEntropy(const QString& fileName, const TimeSeries::blockEntropy_t& entropy,
+                                  const TimeSeries::blockEntropy_t& tendency) {
+    QFile file (fileName);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        return false;
+    QTextStream out (&file);
+    out << "# window " << entropy.diversity.window << " diff " << entropy.diversity.maxdiff
+        << " tendency window " << tendency.diversity.window << " diff " << tendency.diversity.maxdiff << "\n";
+    // the tendency has a value per value of the series, so the curves are of the same length
+    for (int m = 1; m <= entropy.C.size(); ++m)
+        out << m << "\t" << entropy.C[m - 1] << "\t" << tendency.C[m - 1] << "\n";
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+QVector <double> AnalysisEngine::correlations(const QDir& destDir, CorrelationMethod method, int nThreads) {
+    const QString storePath = CoordinatesStore::path(destDir);
+    if (method != CorrelationMethod::pearson)
+        return RankCorrelation (CoordinatesStore (storePath), nThreads).correlations(method);
+    CoMoments moments;
+    if (not moments.read(CoMoments::path(destDir), storePath))
+        moments.add(CoordinatesStore (storePath), nThreads);
+    return moments.correlations();
+}
@@ -0,0 +1,140 @@
+#ifndef ANALYSISENGINE_H_92d5c7a0_3e18_4f6b_a7c4_5b0e81f9d263
+#define ANALYSISENGINE_H_92d5c7a0_3e18_4f6b_a7c4_5b0e81f9d263
+
+#include <atomic>
+#include <bitset>
+#include <thread>
+
+#include <QDir>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "Compressor.h"
+#include "Coordinates.h"
+#include "Hurst.h"
+#include "RankCorrelation.h"
+#include "TimeSeries.h"
+
+/// How a set of series is to be analysed
+struct analysisSettings_t {
+    /// How many half-segments the values domain is divided into, see @c TimeSeries::nLevels
+    unsigned nSegments = 8;
+    HurstEstimator herstEstimator = HurstEstimator::wholeSeries;
+    /// The window of the trajectories, 0 if none are needed, see @c SlidingAnalysis
+    int slidingWindow = 0;
+    int slidingHop = 100;
+    /// Whether to write the block entropy curves, see @c TimeSeries::blockEntropy
+    bool entropyCurves = false;
+    compression_t compression;
+    /// How many worker threads to run, 0 for one per core
+    int nThreads = 0;
+    /// The coordinates to compute, the others are written as NaN
+    std::bitset <coordinates_t::nValues> metrics = std::bitset <coordinates_t::nValues> ().set();
+    /// How the coordinates are correlated once they are computed, the metrics don't depend on it
+    CorrelationMethod correlation = CorrelationMethod::pearson;
+};
+
+/**
+ * @brief The analysis of a set of series with no user interface.
+ *
+ * The coordinates of the series of the set go to the @c CoordinatesStore in the "processed"
+ * directory inside it, then the correlations of the coordinates are computed.
+ * Everything runs on the worker threads; the progress and the results are reported
+ * by the signals, which are queued to the receivers in the other threads as usual.
+ * The workers hand the rows over to the run thread by a lock-free queue and it appends them
+ * in blocks, so the store is only written by one thread; the .coords files of the older
+ * versions are imported first. The @c Manifest tells which series are done with which
+ * parameters: the unchanged series having all the requested metrics are skipped,
+ * so a re-run only analyses the new and the changed series and a stopped one
+ * resumes where it stopped. The values computed are kept in the @c MetricCache
+ * by the parameters each one depends on, so that changing a parameter only
+ * recomputes the coordinates depending on it. The workers fold the coordinates
+ * into @c CoMoments as they go, so the Pearson correlations are ready once they are done;
+ * the rank ones are found by @c RankCorrelation over the store. The workers take the series
+ * by groups, and the short ones of the same length in a group, as the generated sets are,
+ * get the metrics @c SeriesBatch computes all at once.
+ */
+class AnalysisEngine : public QObject {
+    Q_OBJECT
+public:
+    explicit AnalysisEngine (QObject* parent = nullptr);
+    /// Stops the run, if any, and waits for it
+    ~AnalysisEngine ();
+
+    /// Start analysing the set in the directory @p setPath, false if another run is going on
+    bool start (const QString& setPath, const analysisSettings_t& settings);
+    /// Ask the run to stop as soon as the series being processed are done
+    void stop () noexcept { _Stop = true; }
+    /// Block until the run is over
+    void wait ();
+    bool isRunning () const noexcept { return _Running; }
+    /// How many files of the last run were not analysed, see @c processSeries
+    int nFailed () const noexcept { return _Failed; }
+
+    /// The settings the coordinates depend on as a text, see @c Manifest
+    static QString parameters (const analysisSettings_t& settings);
+    /// The settings the @p coordinate depends on as a text, see @c MetricCache
+    static QString metricParameters (size_t coordinate, const analysisSettings_t& settings);
+    /// Where the results for the set in @p setPath go
+    static QString destPath (const QString& setPath);
+    /// The series files of the set, i.e. all the files but the generator coefficients
+    static QStringList seriesList (const QDir& dir);
+    /**
+     * @brief compute the requested coordinates of the series @p fname in @p dir,
+     *  the others are NaN; the trajectory, the entropy curves and the compressors comparison
+     *  go to @p destDir.
+     * @return false if the file is not a time series, the compression failed
+     *  or the trajectory or the entropy curves could not be written
+     */
+    static bool processSeries (const QDir& destDir, const QDir& dir, const QString& fname,
+                               const analysisSettings_t& settings, coordinates_t& coordinates);
+    /**
+     * @brief the same for the series @p ts read from the file @p fname already.
+     *
+     * The @c nLevels() of @p ts must be @c settings.nSegments, so that its codes may come
+     * from a @c SeriesBatch, see @c SeriesBatch::shareEncoding.
+     */
+    static bool processSeries (const QDir& destDir, const QString& fname, const TimeSeries& ts,
+                               const analysisSettings_t& settings, coordinates_t& coordinates);
+    /**
+     * @brief write the entropy curves of a series and of its @p tendency, a line per word length.
+     * @return false if the file could not be written in full
+     */
+    static bool writeEntropy (const QString& fileName, const TimeSeries::blockEntropy_t& entropy,
+                              const TimeSeries::blockEntropy_t& tendency);
+    /**
+     * @brief the correlations of the coordinates of the set processed into the @p destDir,
+     *  see @c CoMoments::correlations and @c RankCorrelation::correlations.
+     *
+     * For the Pearson ones the co-moments kept by the last run are used if the store
+     * has not changed since, otherwise they are accumulated over the store.
+     * @param nThreads how many threads to run, 0 for one per core
+     */
+    static QVector <double> correlations (const QDir& destDir,
+                                          CorrelationMethod method = CorrelationMethod::pearson,
+                                          int nThreads = 0);
+
+signals:
+    /**
+     * @brief how the processing of the series goes.
+     * @param secondsLeft the estimate of the time left, NaN if unknown yet
+     */
+    void processingProgress (int done, int total, double secondsLeft);
+    /// The coordinates are being loaded for the correlations
+    void correlationsStarted ();
+    /// The matrix of @c correlations
+    void correlationsReady (QVector <double> correlations);
+    /// The run is over, @p completed is false if it has been stopped
+    void finished (bool completed);
+
+private:
+    void _Run (QString setPath, analysisSettings_t settings);
+
+    std::thread _Thread;
+    std::atomic <bool> _Stop {false};
+    std::atomic <bool> _Running {false};
+    std::atomic <int> _Failed {0};
+};
+
+#endif // ANALYSISENGINE_H
@@ -1,21 +1,14 @@
 #include "AnalyzeWidget.h"
 #include "ui_AnalyzeWidget.h"
 
+#include "AnalysisEngine.h"
 #include "helpers.h"
-#include "TimeSeries.h"
 
-#include <assert.h>
 #include <chrono>
-#include <deque>
-#include <future>
-#include <iostream>
-#include <queue>
 
-#include <QDebug>
 #include <QFileDialog>
 #include <QLabel>
 #include <QMessageBox>
-#include <QProcess>
 #include <QTextStream>
 
 #ifdef Q_OS_WIN32
@@ -29,6 +22,18 @@ AnalyzeWidget::AnalyzeWidget(QWidget *parent) :
     ui->status->hide();
     ui->progressBar->hide();
 
+    for (HurstEstimator method : HurstEngine::estimators())
+        ui->herstEstimator->addItem(QString::fromUtf8(HurstEngine::name(method)));
+    for (CorrelationMethod method : RankCorrelation::methods())
+        ui->correlationMethod->addItem(QString::fromUtf8(RankCorrelation::name(method)));
+
+    for (CompressorType type : Compressor::types()) {
+        auto item = new QListWidgetItem(QString::fromUtf8(Compressor::name(type)), ui->compressors);
+        item->setData(Qt::UserRole, static_cast <int> (type));
+        item->setCheckState(type == CompressorType::lzma ? Qt::Checked : Qt::Unchecked);
+    }
+    connect(ui->compressors, &QListWidget::itemChanged, this, &AnalyzeWidget::checkPaths);
+
     ui->correlations->setRowCount(coordinates_t::nValues);
     ui->correlations->setColumnCount(coordinates_t::nValues);
     for (size_t i = 0; i < coordinates_t::nValues; ++i) {
@@ -51,12 +56,22 @@ AnalyzeWidget::AnalyzeWidget(QWidget *parent) :
     connect(ui->correlations->horizontalHeader(), &QHeaderView::geometriesChanged,
             this, &AnalyzeWidget::resizeCorrelations);
 
+    engine = new AnalysisEngine (this);
+    connect(engine, &AnalysisEngine::processingProgress, this, &AnalyzeWidget::showProgress);
+    connect(engine, &AnalysisEngine::correlationsStarted, this, [this]{
+        status ("Расчёт корреляций");
+    });
+    connect(engine, &AnalysisEngine::correlationsReady, this, &AnalyzeWidget::showCorrelations);
+    connect(engine, &AnalysisEngine::finished, this, &AnalyzeWidget::analysisFinished);
+
     checkPaths();
     ui->correlationSaveWidget->hide();
     correlations_label->hide();
 }
 
 AnalyzeWidget::~AnalyzeWidget() {
+    engine->stop();
+    engine->wait();
     delete ui;
 }
 
@@ -69,87 +84,6 @@ void AnalyzeWidget::on_browseSetPath_clicked() {
     ui->status->hide();
 }
 
-void processSeries (const QDir& destDir,
-                    const QDir& dir,
-                    const QString& fname,
-                    const QString& compressorCmd,
-                    unsigned nSegments) {
-    QFile coordFile (destDir.absoluteFilePath(fname + ".coords"));
-    if (coordFile.exists())
-            return;
-    // just create a file
-    coordFile.open (QIODevice::WriteOnly | QIODevice::Truncate);
-
-    TimeSeries ts;
-    ts.setNLevels(nSegments);
-    ts.readFile(dir.absoluteFilePath(fname));
-    if (ts.size() < 2)
-        // must have been some wrong file, not a time series
-        return;
-
-    TimeSeries tendency_ts = ts.tendencySeries();
-
-    QFile codedfile (destDir.absoluteFilePath(fname));
-    codedfile.open (QIODevice::WriteOnly | QIODevice::Truncate);
-    auto coded = ts.encoded();
-    for (unsigned c : coded)
-        codedfile.write(reinterpret_cast <const char*> (&c), sizeof (c));
-    codedfile.close();
-
-    QFile tendencyFile (destDir.absoluteFilePath(fname + ".tendency"));
-    tendencyFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
-    for (int8_t c : tendency_ts.values())
-        tendencyFile.write(reinterpret_cast <const char*>(&c), sizeof(c));
-    tendencyFile.close();
-
-    QProcess arc;
-    arc.start(QString(R"(%1 "%2")").arg(compressorCmd).arg (codedfile.fileName()));
-    QProcess t_arc;
-    t_arc.start(QString(R"(%1 "%2")").arg(compressorCmd).arg (tendencyFile.fileName()));
-
-    QTextStream coords (&coordFile);
-
-    coords << ts.harmonicComplexity() << "\n"
-           << tendency_ts.harmonicComplexity() << "\n";
-
-    coords << ts.fractalDimensionality() << "\n"
-           << tendency_ts.fractalDimensionality() << "\n";
-
-    auto diversity = ts.symbolicDiversity();
-    auto tendency_diversity = tendency_ts.symbolicDiversity();
-
-    coords << diversity.window << "\n"
-           << tendency_diversity.window << "\n"
-
-           << diversity.maxdiff << "\n"
-           << tendency_diversity.maxdiff << "\n";
-
-    arc.waitForFinished();
-    auto compressed = arc.readAllStandardOutput();
-
-//        qDebug () << "compressed size:" << compressed.size();
-
-    if (compressed.size() == 0) {
-        qDebug () << "!!! Compressed size == 0, something is wrong!";
-        coordFile.remove();
-/*            QMessageBox::warning(this, tr ("Ошибка сжатия"),
-                             tr("Похоже, указан неправильный файл в качестве компрессора. "
-                                "Он говорит, что сжал все данные до размера 0 байт, так не бывает."));
-        ui->progressBar->hide();
-        status ("Ошибка. Укажите другой компрессор.");
-        return;
-*/
-    } else {
-        coords << 1. / (static_cast <double> (codedfile.size()) / compressed.size() - 1)
-               << "\n";
-        t_arc.waitForFinished();
-        auto t_compressed = t_arc.readAllStandardOutput();
-
-        coords << 1. / (static_cast <double> (tendencyFile.size()) / t_compressed.size() - 1)
-               << "\n";
-    }
-}
-
 template <typename T, typename R>
 std::string to_string(std::chrono::duration<T, R> ns) {
     using namespace std;
@@ -196,241 +130,87 @@ std::string to_string(std::chrono::duration<T, R> ns) {
     return ans;
 }
 
-void process_all_series_background(const QDir& dir, const QDir& destDir,
-                                   const QStringList& lst, int id, int nthreads,
-                                   const volatile std::atomic <bool>* const stop,
-                                   const QString& compressorCmd,
-                                   unsigned nSegments) {
-    std::cerr << "Thread " << id << " out of " << nthreads << " started\n";
-    auto i = lst.constBegin();
-    for (int next = 0; next < id; ++next) {
-        ++i;
-        if (i == lst.constEnd()) {
-            std::cerr << "Thread " << id << " is overkill for this small list, finished\n";
-            return;
-        }
-    }
-
-    while (not *stop) {
-        const auto& fname = *i;
-        processSeries (destDir, dir, fname, compressorCmd, nSegments);
-
-        for (int next = 0; next < nthreads; ++next) {
-            ++i;
-            if (i == lst.constEnd()) {
-                std::cerr << "Thread " << id << " finished\n";
-                return;
-            }
-        }
-    }
-    std::cerr << "Thread " << id << " interrupted and terminated\n";
-}
-
-void AnalyzeWidget::processAllSeries() {
-    QDir dir (ui->setPath->text());
-    QDir destDir(destPath());
-    destDir.mkdir(destDir.absolutePath());
-    status ("Обработка временных рядов...\nЗагрузка данных");
-    ui->progressBar->show();
-    ui->progressBar->setValue(0);
-    QStringList lst = dir.entryList(QDir::Readable | QDir::Files);
-    for (auto i = lst.begin(); i != lst.end();) {
-        if (i->toLower().endsWith(".coeffts"))
-            i = lst.erase(i);
-        else
-            ++i;
-    }
-#ifdef QT_DEBUG
-    const auto nthreads = 1u;
-#else
-    const auto nthreads = std::thread::hardware_concurrency();
-#endif
-    const auto N = lst.size() / nthreads;
-    ui->progressBar->setMaximum(N);
-    QApplication::processEvents();
-    std::queue <std::chrono::steady_clock::time_point> times;
-    const size_t qsize = [N]{
-        auto ans = std::min (500u, N / 50);
-        return std::max (5u, ans);
-    }();
-    int progress = 0;
-    std::vector <std::future <void>> workers;
-    workers.reserve(nthreads - 1);
-    const unsigned nSegments = ui->nSegments->value();
-    const auto compressorCmd = QString (R"("%1" %2)")
-            .arg(ui->lzmaPath->text())
-            .arg(ui->lzmaArgs->text());
-    for (int id = nthreads - 1; id > 0; --id)
-        workers.push_back(std::async(std::launch::async,
-                                     process_all_series_background, dir, destDir,
-                                     lst, id, nthreads, &stop,
-                                     compressorCmd,
-                                     nSegments));
-
-    // lambda here is a syntax sugar for 'return' below
-    [&]{
-    for (auto i = lst.constBegin(); not stop;) {
-        const auto& fname = *i;
-
-        auto now = std::chrono::steady_clock::now();
-        times.push(now);
-        if (times.size() <= qsize) {
-            status (tr("Обработка временных рядов...\n%1").arg(fname));
-        } else {
-            auto start = times.front();
-            times.pop();
-            auto qtime = now - start;
-            auto sleft = N - progress;
-            auto left = sleft * (qtime / qsize);
-            status (tr("Обработка временных рядов...\n%1\nОсталось %2")
-                    .arg(fname)
-                    .arg(QString::fromStdString(to_string(left))));
-        }
-        if (not fname.toLower().endsWith(".coeffts"))
-            processSeries (destDir, dir, fname, compressorCmd, nSegments);
-
-        ui->progressBar->setValue(++progress);
-        if (unsigned (progress) % 2)
-            QApplication::processEvents();
-
-        for (unsigned next = 0; next < nthreads; ++next) {
-            ++i;
-            if (i == lst.constEnd())
-                return; //< from the lambda
-        }
-    }
-    }();
-
-    status("Обработка временных рядов...\nОжидание завершения всех потоков");
-
-    for (auto&& f : workers) {
-        f.get();
+void AnalyzeWidget::showProgress(int done, int total, double secondsLeft) {
+    ui->progressBar->setMaximum(total);
+    ui->progressBar->setValue(done);
+    if (std::isfinite(secondsLeft) and done > 0) {
+        const std::chrono::seconds left (static_cast <long long> (secondsLeft));
+        status (tr("Обработка временных рядов...\nОбработано %1 из %2\nОсталось %3")
+                .arg(done)
+                .arg(total)
+                .arg(QString::fromStdString(to_string(left))));
+    } else {
+        status (tr("Обработка временных рядов...\nОбработано %1 из %2")
+                .arg(done)
+                .arg(total));
     }
-
-    status("Все временные ряды обработаны!");
-    ui->progressBar->hide();
 }
 
-void AnalyzeWidget::FindCorrelations() {
-    status ("Расчёт корреляций: загрузка данных");
-    QApplication::processEvents();
-
-    QDir processed (destPath());
-    ui->progressBar->setValue(0);
-    QStringList lst = processed.entryList(QStringList() << "*.coords",
-                                          QDir::Readable | QDir::Files);
-    ui->progressBar->setMaximum(lst.size());
-    QApplication::processEvents();
-
-    QVector <coordinates_t> src_matrix (lst.size());
-
-    int progress = 0;
-    for (QString fname : lst) {
-        QFile file (processed.filePath(fname));
-        file.open(QIODevice::ReadOnly);
-        QTextStream coordinates (&file);
-        for (size_t j = 0; j < coordinates_t::nValues; ++j) {
-            coordinates >> src_matrix [progress].values[j];
-        }
-        ui->progressBar->setValue(++progress);
-        QApplication::processEvents();
-    }
-
-    status ("Расчёт корреляций: обработка данных");
-    ui->progressBar->setValue(progress = 0);
-    ui->progressBar->setMaximum(coordinates_t::nValues * (coordinates_t::nValues - 1) / 2);
+void AnalyzeWidget::showCorrelations(const QVector <double>& correlations) {
+    const size_t n = coordinates_t::nValues;
     ui->correlations->setVisible(true);
     correlations_label->show();
-    QApplication::processEvents();
-
-    QVector <double> E (coordinates_t::nValues, 0.), //< empirical expectation of v[i]
-                     D (coordinates_t::nValues, 0.); //< sum of squares of diffs of v[i]
-
-    for (size_t i = 0; i < coordinates_t::nValues; ++i) {
-        E [i] = std::accumulate (src_matrix.begin(), src_matrix.end(), 0.,
-                                 [i](double s, const coordinates_t& v)
-                                 { if (isnan (v.values[i])) return s;
-                                   return s + v.values[i];
-                                 }) / src_matrix.size();
-
-        D [i] = std::accumulate (src_matrix.begin(), src_matrix.end(), 0.,
-                                [i, E](double s, const coordinates_t& v)
-                                {   if (isnan (v.values[i])) return s;
-                                    return s + std::pow (v.values[i] - E[i], 2);
-                                });
-    }
-
-    for (size_t i = 0; i < coordinates_t::nValues; ++i) {
-        if (D[i] == 0) {
-            qDebug () << "Дисперия координаты"
-                      << coordinates_t::coordinateName(i)
-                      << "равна нулю! Исправьте выборку.";
-        } else if (std::isnan(D[i])) {
-            qDebug () << "Дисперия координаты"
-                      << coordinates_t::coordinateName(i)
-                      << "— nan! Исправьте программу или выборку.";
-        }
-//        QTableWidgetItem* item = ui->correlations->item(i, i);
-//        if (item == nullptr) {
-//            item = new QTableWidgetItem ("1");
-//            ui->correlations->setItem(i, i, item);
-//        }
-        for (size_t j = i; j < coordinates_t::nValues; ++j) {
-            double quantifier = std::accumulate (src_matrix.begin(), src_matrix.end(), 0.,
-                                                [i, j, E](double s, const coordinates_t& v)
-                                                {   if (isnan (v.values[i]) or isnan (v.values[j])) return s;
-                                                    return s + (v.values[i] - E[i]) * (v.values[j] - E[j]);
-                                                });
-            double denominator = sqrt(D[i] * D[j]);
-            // denominator maybe near 0. which will produce infinity as a result.
-            // That is not considered a error.
-
-            double answer = quantifier / denominator;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            const double answer = correlations[i * n + j];
             QString sanswer = QString::number(answer);
             auto item = ui->correlations->item(i, j);
-            auto setColor = [answer](QTableWidgetItem* item){
-                if (std::isnan(answer))
-                    item->setBackgroundColor(QColor::fromRgb(255, 180, 180));
-                else
-                    item->setBackgroundColor(QColor::fromRgb(127 + fabs (answer) * 128, 255, 127 + fabs (answer) * 128));
-            };
             if (item == nullptr) {
                 item = new QTableWidgetItem (sanswer);
-                setColor(item);
                 ui->correlations->setItem(i, j, item);
-
-                item = new QTableWidgetItem (sanswer);
-                setColor(item);
-                ui->correlations->setItem(j, i, item);
             } else {
                 item->setText(sanswer);
-                setColor(item);
-                ui->correlations->item(j, i)->setText(sanswer);
             }
-
-            ui->progressBar->setValue(++progress);
-            QApplication::processEvents();
+            if (std::isnan(answer))
+                item->setBackgroundColor(QColor::fromRgb(255, 180, 180));
+            else
+                item->setBackgroundColor(QColor::fromRgb(127 + fabs (answer) * 128, 255, 127 + fabs (answer) * 128));
         }
     }
     ui->correlationSaveWidget->show();
 }
 
+void AnalyzeWidget::analysisFinished(bool completed) {
+    if (completed)
+        ui->status->hide();
+    else
+        status(tr("Обработка прервана"));
+    ui->progressBar->hide();
+    ui->go->setEnabled(true);
+}
+
 void AnalyzeWidget::status(const QString &message) {
     ui->status->show();
     ui->status->setText(message);
 }
 
 void AnalyzeWidget::on_go_clicked() {
+    analysisSettings_t settings;
+    settings.nSegments = ui->nSegments->value();
+    settings.herstEstimator = static_cast <HurstEstimator> (ui->herstEstimator->currentIndex());
+    settings.slidingWindow = ui->slidingWindow->value();
+    settings.slidingHop = ui->slidingHop->value();
+    settings.entropyCurves = ui->entropyCurves->isChecked();
+    for (int i = 0; i < ui->compressors->count(); ++i) {
+        const QListWidgetItem* item = ui->compressors->item(i);
+        if (item->checkState() == Qt::Checked)
+            settings.compression.types.append(static_cast <CompressorType> (item->data(Qt::UserRole).toInt()));
+    }
+    settings.compression.level = ui->compressionLevel->value();
+    settings.compression.extreme = ui->compressionExtreme->isChecked();
+    settings.correlation = static_cast <CorrelationMethod> (ui->correlationMethod->currentIndex());
+
+    if (not engine->start(ui->setPath->text(), settings))
+        return;
+    correlation = settings.correlation;
+    correlations_label->setText(tr("Матрица корреляций %1")
+                                .arg(QString::fromUtf8(RankCorrelation::name(correlation))));
     ui->go->setEnabled(false);
     ui->correlations->hide();
     correlations_label->hide();
-
-    processAllSeries();
-    FindCorrelations();
-
-    ui->status->hide();
-    ui->progressBar->hide();
-    ui->go->setEnabled(true);
+    status ("Обработка временных рядов...\nЗагрузка данных");
+    ui->progressBar->setValue(0);
+    ui->progressBar->show();
 }
 
 void AnalyzeWidget::resizeCorrelations() {
@@ -440,55 +220,35 @@ void AnalyzeWidget::resizeCorrelations() {
 }
 
 void AnalyzeWidget::checkPaths() {
-    QFile lzma (ui->lzmaPath->text());
-    lzma.open(QIODevice::ReadOnly);
     QDir setDir (ui->setPath->text());
 
-    bool lzma_ok = lzma.isReadable(),
-         set_ok = setDir.isReadable();
+    bool set_ok = setDir.isReadable();
+    bool compressor_ok = false;
+    for (int i = 0; i < ui->compressors->count(); ++i)
+        compressor_ok = compressor_ok or ui->compressors->item(i)->checkState() == Qt::Checked;
 
-    setErrorBackground(ui->lzmaPath, not lzma_ok,
-                       tr("Путь к архиватору"));
     setErrorBackground(ui->setPath, not set_ok,
                        tr("Папка с выборкой временных рядов"));
-    ui->go->setEnabled(lzma_ok and set_ok);
-}
-
-QString AnalyzeWidget::destPath() {
-    return QDir(ui->setPath->text()).filePath("processed");
-}
-
-void AnalyzeWidget::on_setPath_textChanged(const QString &arg1) {
-    QDir f(arg1);
-    setErrorBackground(ui->setPath, not f.isReadable(),
-                       tr("Папка с выборкой временных рядов"));
-    ui->go->setEnabled(f.isReadable());
+    setErrorBackground(ui->compressors, not compressor_ok,
+                       tr("Компрессоры для оценки колмогоровской сложности"),
+                       tr("Выберите хотя бы один компрессор"));
+    ui->go->setEnabled(set_ok and compressor_ok);
 }
 
-void AnalyzeWidget::on_browseLzmaPath_clicked() {
-    auto ans = QFileDialog::getOpenFileName(this,
-                                 tr("Укажите архиватор lzma"),
-                                 ui->lzmaPath->text());
-    if (not ans.isNull())
-        ui->lzmaPath->setText(ans);
-    ui->status->hide();
-}
-
-void AnalyzeWidget::on_lzmaPath_textChanged(const QString &arg1) {
-    QDir f(arg1);
-    setErrorBackground(ui->lzmaPath, not f.isReadable(),
-                       tr("Путь к архиватору"));
-    ui->go->setEnabled(f.isReadable());
+void AnalyzeWidget::on_setPath_textChanged(const QString &) {
+    checkPaths();
 }
 
 void AnalyzeWidget::on_AnalyzeWidget_destroyed() {
-    stop = true;
+    engine->stop();
 }
 
 void AnalyzeWidget::on_saveCorrelations_clicked() {
+    const QString suggested = QDir (ui->setPath->text())
+            .filePath(QString ("correlations-%1.csv").arg(RankCorrelation::id(correlation)));
     auto fname = QFileDialog::getSaveFileName(this,
                                               tr("Куда сохранить таблицу?"),
-                                              ui->setPath->text(),
+                                              suggested,
                                               tr("csv (*.csv)"));
 
     if (fname.isNull())
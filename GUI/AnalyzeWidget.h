@@ -1,9 +1,12 @@
 #ifndef ANALYZEWIDGET_H
 #define ANALYZEWIDGET_H
 
-#include <atomic>
+#include <QVector>
 #include <QWidget>
 
+#include "RankCorrelation.h"
+
+class AnalysisEngine;
 class QLabel;
 namespace Ui {
 class AnalyzeWidget;
@@ -19,27 +22,27 @@ public:
 
 
 private slots:
-    void on_browseLzmaPath_clicked();
     void on_browseSetPath_clicked();
-    void processAllSeries ();
-    void FindCorrelations ();
     void status (const QString& message);
+    void showProgress (int done, int total, double secondsLeft);
+    void showCorrelations (const QVector <double>& correlations);
+    void analysisFinished (bool completed);
     void on_go_clicked();
     void resizeCorrelations();
     void checkPaths();
     void on_setPath_textChanged(const QString &arg1);
-    void on_lzmaPath_textChanged(const QString &arg1);
 
     void on_AnalyzeWidget_destroyed();
 
     void on_saveCorrelations_clicked();
 
 private:
-    /// Get the directory with the result of the program
-    QString destPath ();
     QLabel* correlations_label = nullptr;
     Ui::AnalyzeWidget *ui;
-    std::atomic <bool> stop {false};
+    /// Does all the work in the background
+    AnalysisEngine* engine = nullptr;
+    /// The correlations of the run shown or going on
+    CorrelationMethod correlation = CorrelationMethod::pearson;
 };
 
 #endif // ANALYZEWIDGET_H
@@ -0,0 +1,192 @@
+#include "CoMoments.h"
+#include "CoordinatesStore.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+
+namespace {
+const QString magic = "tsanalyzer-comoments";
+}
+
+CoMoments::CoMoments() = default;
+
+void CoMoments::add(const coordinates_t& coordinates) {
+    const double* v = coordinates.values;
+    ++_NSeries;
+    for (size_t i = 0; i < coordinates_t::nValues; ++i) {
+        if (std::isnan (v[i]))
+            continue;
+        for (size_t j = i; j < coordinates_t::nValues; ++j)
+            if (not std::isnan (v[j]))
+                _Pairs[_Index (i, j)].add(v[i], v[j]);
+    }
+}
+
+void CoMoments::add(const CoordinatesStore& store, int nThreads) {
+    // the blocks of the store are cut into chunks for the workers
+    struct chunk_t {
+        int block, begin, end;
+    };
+    const int chunkRows = 1 << 14;
+    QVector <chunk_t> chunks;
+    QVector <qint64> costs;
+    for (int b = 0; b < store.nBlocks(); ++b) {
+        for (int begin = 0; begin < store.blockRows(b); begin += chunkRows) {
+            chunks.append(chunk_t {b, begin, std::min (begin + chunkRows, store.blockRows(b))});
+            costs.append(chunks.last().end - begin);
+        }
+    }
+    if (chunks.isEmpty())
+        return;
+    if (nThreads <= 0)
+        nThreads = static_cast <int> (std::thread::hardware_concurrency());
+    nThreads = std::max (1, std::min (nThreads, chunks.size()));
+
+    QVector <CoMoments> partial (nThreads);
+    {
+        TaskPool pool (costs, [&store, &chunks, &partial](int i){
+            const chunk_t& chunk = chunks[i];
+            const int n = chunk.end - chunk.begin;
+            const double* columns[coordinates_t::nValues];
+            for (size_t c = 0; c < coordinates_t::nValues; ++c)
+                columns[c] = store.column(chunk.block, c).data() + chunk.begin;
+            std::vector <uint8_t> live;
+            if (store.nLiveRows() != store.nRows()) {
+                live.resize(n);
+                for (int r = 0; r < n; ++r)
+                    live[r] = store.isLive(chunk.block, chunk.begin + r);
+            }
+            CoMoments& moments = partial[TaskPool::workerId()];
+            accumulateComoments (columns, coordinates_t::nValues, n,
+                                 live.empty() ? nullptr : live.data(), moments._Pairs);
+        }, nThreads);
+        while (not pool.wait(100))
+            ;
+    }
+    for (const CoMoments& moments : partial)
+        merge(moments);
+    _NSeries += store.nLiveRows();
+}
+
+void CoMoments::merge(const CoMoments& other) {
+    _NSeries += other._NSeries;
+    for (size_t k = 0; k < _NPairs; ++k)
+        _Pairs[k].merge(other._Pairs[k]);
+}
+
+void CoMoments::remove(const CoMoments& other) {
+    _NSeries -= other._NSeries;
+    for (size_t k = 0; k < _NPairs; ++k)
+        _Pairs[k].remove(other._Pairs[k]);
+}
+
+QVector <double> CoMoments::correlations() const {
+    const size_t n = coordinates_t::nValues;
+    for (size_t i = 0; i < n; ++i) {
+        const double D = _Pairs[_Index (i, i)].m2X;
+        if (D == 0) {
+            qDebug () << "Дисперия координаты"
+                      << coordinates_t::coordinateName(i)
+                      << "равна нулю! Исправьте выборку.";
+        } else if (std::isnan(D)) {
+            qDebug () << "Дисперия координаты"
+                      << coordinates_t::coordinateName(i)
+                      << "— nan! Исправьте программу или выборку.";
+        }
+    }
+
+    QVector <double> ans (n * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i; j < n; ++j) {
+            const comoments_t& p = _Pairs[_Index (i, j)];
+            // denominator maybe near 0. which will produce infinity as a result.
+            // That is not considered a error.
+            ans[i * n + j] = ans[j * n + i] = p.c / std::sqrt (p.m2X * p.m2Y);
+        }
+    }
+    return ans;
+}
+
+QString CoMoments::_StoreStamp(const QString& storePath) {
+    const QFileInfo info (storePath);
+    return QString ("%1 %2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch());
+}
+
+bool CoMoments::read(const QString& fileName, const QString& storePath) {
+    QFile file (fileName);
+    if (not file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    QTextStream in (&file);
+    QStringList fields = in.readLine().split('\t');
+    if (fields.size() != 2 or fields[0] != magic or fields[1].toInt() != currentVersion)
+        return false;
+    fields = in.readLine().split('\t');
+    bool ok = false;
+    if (fields.size() != 3 or fields[0] != "store" or fields[1] != _StoreStamp (storePath))
+        return false;
+    const qint64 nSeries = fields[2].toLongLong(&ok);
+    if (not ok)
+        return false;
+
+    CoMoments ans;
+    ans._NSeries = nSeries;
+    int nPairs = 0;
+    while (not in.atEnd()) {
+        fields = in.readLine().split('\t');
+        if (fields.size() == 1 and fields[0].isEmpty())
+            continue;
+        if (fields.size() != 8)
+            return false;
+        const size_t i = coordinates_t::coordinateIndex(fields[0]),
+                     j = coordinates_t::coordinateIndex(fields[1]);
+        if (i >= coordinates_t::nValues or j >= coordinates_t::nValues or i > j)
+            return false;
+        comoments_t& p = ans._Pairs[_Index (i, j)];
+        double* values[] = {&p.n, &p.meanX, &p.meanY, &p.m2X, &p.m2Y, &p.c};
+        for (int k = 0; k < 6 and ok; ++k)
+            *values[k] = fields[k + 2].toDouble(&ok);
+        if (not ok)
+            return false;
+        ++nPairs;
+    }
+    if (nPairs != static_cast <int> (_NPairs))
+        return false;
+    *this = ans;
+    return true;
+}
+
+bool CoMoments::write(const QString& fileName, const QString& storePath) const {
+    QSaveFile file (fileName);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    QTextStream out (&file);
+    // the sums go on from where they were, they must come back exactly
+    out.setRealNumberPrecision(17);
+    out << magic << '\t' << currentVersion << '\n'
+        << "store\t" << _StoreStamp (storePath) << '\t' << _NSeries << '\n';
+    for (size_t i = 0; i < coordinates_t::nValues; ++i) {
+        for (size_t j = i; j < coordinates_t::nValues; ++j) {
+            const comoments_t& p = _Pairs[_Index (i, j)];
+            out << coordinates_t::coordinateId(i) << '\t' << coordinates_t::coordinateId(j) << '\t'
+                << p.n << '\t' << p.meanX << '\t' << p.meanY << '\t'
+                << p.m2X << '\t' << p.m2Y << '\t' << p.c << '\n';
+        }
+    }
+    out.flush();
+    return out.status() == QTextStream::Ok and file.commit();
+}
+
+QString CoMoments::path(const QDir& destDir) {
+    return destDir.absoluteFilePath(momentsName);
+}
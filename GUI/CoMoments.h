@@ -0,0 +1,77 @@
+#ifndef COMOMENTS_H_e6b03f17_85c2_4d9a_b741_2f9c0a63d8e5
+#define COMOMENTS_H_e6b03f17_85c2_4d9a_b741_2f9c0a63d8e5
+
+#include <QDir>
+#include <QVector>
+
+#include "Coordinates.h"
+#include "CovarianceKernel.h"
+
+class CoordinatesStore;
+
+/**
+ * @brief The co-moments of every pair of coordinates, accumulated one series at a time.
+ *
+ * For each pair the rows where both coordinates are not NaN count, and their number,
+ * the means and the sums of the squared deviations and of the products of the deviations
+ * are updated by Welford's method, see @c comoments_t, or by the blocks of a store at once.
+ * Two accumulators of disjoint rows are merged
+ * by the formula of Chan et al., and the rows of one accumulator are removed
+ * from another one having them by the inverse of it: the workers fold their series
+ * into the accumulators of their own, merged once they are done, and the rows
+ * superseded by a run are taken out of the accumulator of the previous ones.
+ *
+ * The accumulator of a set is kept in a text file in the processed directory
+ * along with the size and the modification time of the store it is of,
+ * see @c read and @c write.
+ */
+class CoMoments {
+public:
+    static constexpr int currentVersion = 1;
+    /// The name of the file in the processed directory of a set
+    static constexpr const char* momentsName = "comoments.tsv";
+
+    CoMoments ();
+
+    /// Fold in a series
+    void add (const coordinates_t& coordinates);
+    /**
+     * @brief fold in the live rows of the @p store, see @c accumulateComoments.
+     * @param nThreads how many threads share the rows, 0 for one per core
+     */
+    void add (const CoordinatesStore& store, int nThreads = 0);
+    /// Fold in the rows of the @p other accumulator, none of them must be here
+    void merge (const CoMoments& other);
+    /// Take out the rows of the @p other accumulator, all of them must be here
+    void remove (const CoMoments& other);
+    /// How many series have been folded in, NaN or not
+    qint64 nSeries () const noexcept { return _NSeries; }
+
+    /**
+     * @brief the Pearson correlations of the coordinates, each pair over the rows having both.
+     * @return the nValues × nValues matrix by rows, not finite where a variance is 0
+     */
+    QVector <double> correlations () const;
+
+    /// Read the accumulator, false if there is none or it is not of the store as it is now
+    bool read (const QString& fileName, const QString& storePath);
+    /// Atomically write the accumulator of the store as it is now, false on errors
+    bool write (const QString& fileName, const QString& storePath) const;
+
+    /// The file of the set processed into the @p destDir
+    static QString path (const QDir& destDir);
+
+private:
+    static constexpr size_t _NPairs = coordinates_t::nValues * (coordinates_t::nValues + 1) / 2;
+    /// The pair i ≤ j
+    static size_t _Index (size_t i, size_t j) noexcept {
+        return pairIndex (i, j, coordinates_t::nValues);
+    }
+    /// What the @p storePath is like now, the accumulator only stands for the store it was written with
+    static QString _StoreStamp (const QString& storePath);
+
+    comoments_t _Pairs [_NPairs];
+    qint64 _NSeries = 0;
+};
+
+#endif // COMOMENTS_H
@@ -0,0 +1,55 @@
+#include "Compressor.h"
+#include "DeflateEncoder.h"
+#include "Lz77Encoder.h"
+#include "LzmaEncoder.h"
+#include "PpmEncoder.h"
+
+constexpr int Compressor::maxLevel;
+constexpr int Compressor::defaultLevel;
+
+Compressor::~Compressor() = default;
+
+const char* Compressor::name(CompressorType type) {
+    switch (type) {
+    case CompressorType::lzma:    return "LZMA";
+    case CompressorType::deflate: return "Deflate";
+    case CompressorType::lz77:    return "LZ77 + энтропийное";
+    case CompressorType::ppm:     return "PPM";
+    }
+    return "???";
+}
+
+const char* Compressor::id(CompressorType type) {
+    switch (type) {
+    case CompressorType::lzma:    return "lzma";
+    case CompressorType::deflate: return "deflate";
+    case CompressorType::lz77:    return "lz77";
+    case CompressorType::ppm:     return "ppm";
+    }
+    return "???";
+}
+
+QVector <CompressorType> Compressor::types() {
+    return QVector <CompressorType> {CompressorType::lzma, CompressorType::deflate,
+                                     CompressorType::lz77, CompressorType::ppm};
+}
+
+std::unique_ptr <Compressor> Compressor::create(CompressorType type) {
+    switch (type) {
+    case CompressorType::lzma:    return std::unique_ptr <Compressor> (new LzmaEncoder);
+    case CompressorType::deflate: return std::unique_ptr <Compressor> (new DeflateEncoder);
+    case CompressorType::lz77:    return std::unique_ptr <Compressor> (new Lz77Encoder);
+    case CompressorType::ppm:     return std::unique_ptr <Compressor> (new PpmEncoder);
+    }
+    return nullptr;
+}
+
+Compressor& Compressor::local(CompressorType type, int level, bool extreme) {
+    // one of each type per thread, created on the first use
+    thread_local std::unique_ptr <Compressor> pool[static_cast <int> (CompressorType::ppm) + 1];
+    auto& compressor = pool[static_cast <int> (type)];
+    if (not compressor)
+        compressor = create (type);
+    compressor->setLevel(level, extreme);
+    return *compressor;
+}
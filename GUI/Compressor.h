@@ -0,0 +1,69 @@
+#ifndef COMPRESSOR_H_6d1b8e30_5a7f_4c92_b1e4_0f83c9a2d765
+#define COMPRESSOR_H_6d1b8e30_5a7f_4c92_b1e4_0f83c9a2d765
+
+#include <memory>
+
+#include <QVector>
+
+/// Compressors to estimate the Kolmogorov complexity with
+enum class CompressorType {
+    /// LZMA, the original estimator, see @c LzmaEncoder
+    lzma,
+    /// zlib deflate: LZ77 with a 32 KiB window and Huffman codes
+    deflate,
+    /// LZ77 with a larger window and adaptive entropy coding, see @c Lz77Encoder
+    lz77,
+    /// prediction by partial matching, see @c PpmEncoder
+    ppm
+};
+
+/**
+ * @brief A compressor that only measures how well the data compress.
+ *
+ * An implementation keeps its working memory, i.e. the dictionaries, the match finders
+ * and the models, between the calls and only resets it for the next data.
+ * So a compressor is not to be shared among threads: @c local gives each thread its own.
+ */
+class Compressor {
+public:
+    /// The levels are 0..maxLevel, higher ones compress better and slower
+    static constexpr int maxLevel = 9;
+    static constexpr int defaultLevel = 6;
+
+    virtual ~Compressor ();
+
+    int level () const noexcept { return _Level; }
+    /// Whether to try even harder than the @c level says, if the compressor can
+    bool extreme () const noexcept { return _Extreme; }
+    void setLevel (int level, bool extreme = false) noexcept {
+        _Level = level;
+        _Extreme = extreme;
+    }
+
+    /// The size of the compressed @p data including the headers of the format, -1 on errors
+    virtual qint64 compressedSize (const void* data, qint64 size) = 0;
+
+    /// User-readable name of the compressor
+    static const char* name (CompressorType type);
+    /// Machine-readable name of the compressor
+    static const char* id (CompressorType type);
+    /// All the compressors, the original one first
+    static QVector <CompressorType> types ();
+    static std::unique_ptr <Compressor> create (CompressorType type);
+    /// The compressor of the calling thread, set to the @p level
+    static Compressor& local (CompressorType type, int level = defaultLevel, bool extreme = false);
+
+protected:
+    int _Level = defaultLevel;
+    bool _Extreme = false;
+};
+
+/// Which compressors estimate the Kolmogorov complexity and how hard they try
+struct compression_t {
+    /// The first one gives the Kolmogorov coordinates, the rest are for comparison
+    QVector <CompressorType> types;
+    int level = Compressor::defaultLevel;
+    bool extreme = false;
+};
+
+#endif // COMPRESSOR_H
@@ -0,0 +1,46 @@
+#include "Coordinates.h"
+
+#include <QString>
+
+const char* coordinates_t::coordinateName(size_t index) {
+    switch (index) {
+    case 0: return "Гармоническая сложность";
+    case 1: return "Гармоническая сложность тенденций";
+    case 2: return "Фрактальная размерность";
+    case 3: return "Фрактальная размерность тенденций";
+    case 4: return "Символьное разнообразие: окно";
+    case 5: return "Символьное разнообразие тенденций: окно";
+    case 6: return "Символьное разнообразие: разность";
+    case 7: return "Символьное разнообразие тенденций: разность";
+    case 8: return "Колмогоровская сложность";
+    case 9: return "Колмогоровская сложность тенденций";
+    case 10: return "Сложность Лемпеля — Зива";
+    case 11: return "Сложность Лемпеля — Зива тенденций";
+    }
+    return "???";
+}
+
+const char* coordinates_t::coordinateId(size_t index) {
+    switch (index) {
+    case 0: return "harmonicComplexity";
+    case 1: return "tendencyHarmonicComplexity";
+    case 2: return "fractalDimensionality";
+    case 3: return "tendencyFractalDimensionality";
+    case 4: return "symbolicDiversityWindow";
+    case 5: return "tendencySymbolicDiversityWindow";
+    case 6: return "symbolicDiversityDiff";
+    case 7: return "tendencySymbolicDiversityDiff";
+    case 8: return "KolmogorovComplexity";
+    case 9: return "tendencyKolmogorovComplexity";
+    case 10: return "LempelZivComplexity";
+    case 11: return "tendencyLempelZivComplexity";
+    }
+    return "???";
+}
+
+size_t coordinates_t::coordinateIndex(const QString& id) {
+    size_t i = 0;
+    while (i < nValues and id != QLatin1String (coordinateId(i)))
+        ++i;
+    return i;
+}
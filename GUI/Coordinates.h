@@ -0,0 +1,37 @@
+#ifndef COORDINATES_H_3f8a61c2_d94e_4b07_8a15_c62e07b9d4f1
+#define COORDINATES_H_3f8a61c2_d94e_4b07_8a15_c62e07b9d4f1
+
+// for size_t
+#include <cstddef>
+
+class QString;
+
+/// The metrics of a series, its coordinates in the space the correlations are found in
+struct coordinates_t {
+    static constexpr size_t nValues = 12;
+    union {
+        double values [nValues];
+        struct {
+            double harmonicComplexity,
+                   tendencyHarmonicComplexity,
+                   fractalDimensionality,
+                   tendencyFractalDimensionality,
+                   symbolicDiversityWindow,
+                   tendencySymbolicDiversityWindow,
+                   symbolicDiversityDiff,
+                   tendencySymbolicDiversityDiff,
+                   KolmogorovComplexity,
+                   tendencyKolmogorovComplexity,
+                   LempelZivComplexity,
+                   tendencyLempelZivComplexity;
+        } by_name;
+    };
+    /// User-readable coordinate name (in Russian)
+    static const char* coordinateName (size_t index);
+    /// Machine-readable coordinate name, the same as the one of its field in @c by_name
+    static const char* coordinateId (size_t index);
+    /// The index of the coordinate with the given @c coordinateId, nValues if there is none
+    static size_t coordinateIndex (const QString& id);
+};
+
+#endif // COORDINATES_H
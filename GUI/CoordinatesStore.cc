@@ -0,0 +1,435 @@
+#include "CoordinatesStore.h"
+
+#include <QDebug>
+#include <QHash>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QtGlobal>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+static_assert (Q_BYTE_ORDER == Q_LITTLE_ENDIAN,
+               "the .tsc columns are mapped as they are, so only little-endian hosts are supported");
+static_assert (sizeof (CoordinatesStore::header_t) == 16, "the header must be packed");
+static_assert (sizeof (CoordinatesStore::block_t) == 32, "the block header must be packed");
+static_assert (sizeof (CoordinatesStore::trailer_t) == 16, "the trailer must be packed");
+
+namespace {
+constexpr char magic[4] = {'T', 'S', 'C', '\x1a'};
+constexpr char blockMagic[4] = {'T', 'S', 'C', 'B'};
+constexpr char footerMagic[4] = {'T', 'S', 'C', 'F'};
+
+/// How many values the .coords files of the versions before the Lempel-Ziv complexities have
+constexpr size_t legacyValues = 10;
+
+uint64_t aligned (uint64_t offset) {
+    return (offset + CoordinatesStore::alignment - 1)
+           / CoordinatesStore::alignment * CoordinatesStore::alignment;
+}
+
+/// Where the arrays of a block of @p nRows rows are from its beginning
+struct blockLayout_t {
+    uint64_t ids, columns[coordinates_t::nValues], nameOffsets, names, size;
+
+    blockLayout_t (uint64_t nRows, uint64_t namesSize) {
+        ids = aligned (sizeof (CoordinatesStore::block_t));
+        uint64_t end = ids + nRows * sizeof (uint64_t);
+        for (uint64_t& column : columns) {
+            column = aligned (end);
+            end = column + nRows * sizeof (double);
+        }
+        nameOffsets = aligned (end);
+        names = aligned (nameOffsets + (nRows + 1) * sizeof (uint32_t));
+        size = aligned (names + namesSize);
+    }
+};
+
+const uint64_t firstBlock = aligned (sizeof (CoordinatesStore::header_t));
+}
+
+CoordinatesStore::CoordinatesStore(const QString& fileName)
+    : _File (fileName) {
+    if (not _File.exists()) {
+        _Valid = true;
+        return;
+    }
+    if (not _File.open(QIODevice::ReadOnly))
+        return;
+    const qint64 fileSize = _File.size();
+    if (fileSize < static_cast <qint64> (sizeof (header_t)))
+        return;
+    const uchar* data = _File.map(0, fileSize);
+    if (not data)
+        return;
+
+    _Layout layout;
+    if (not _Scan (data, fileSize, layout))
+        return;
+
+    for (uint64_t offset : layout.blocks)
+        _AddBlock (data + offset);
+
+    _NLiveRows = _NRows;
+    if (_Blocks.size() > 1) {
+        // a series appended again supersedes its older rows; the ids tell the series
+        // apart unless two names share one, those go by the names themselves
+        struct location_t {
+            int block, row;
+        };
+        QHash <uint64_t, location_t> lastRow;
+        QHash <QString, location_t> collided;
+        auto sameName = [this](const location_t& a, const location_t& b) {
+            const _BlockView& x = _Blocks[a.block];
+            const _BlockView& y = _Blocks[b.block];
+            const uint32_t size = x.nameOffsets[a.row + 1] - x.nameOffsets[a.row];
+            return size == y.nameOffsets[b.row + 1] - y.nameOffsets[b.row]
+                   and memcmp (x.names + x.nameOffsets[a.row], y.names + y.nameOffsets[b.row], size) == 0;
+        };
+        auto supersede = [this](const location_t& l) {
+            _Superseded[_Blocks[l.block].firstRow + l.row] = true;
+            --_NLiveRows;
+        };
+        _Superseded.fill(false, _NRows);
+        for (int k = 0; k < _Blocks.size(); ++k) {
+            const _BlockView& b = _Blocks[k];
+            for (int r = 0; r < b.nRows; ++r) {
+                const location_t here {k, r};
+                const auto previous = lastRow.constFind(b.ids[r]);
+                if (previous == lastRow.constEnd()) {
+                    lastRow.insert(b.ids[r], here);
+                } else if (sameName (*previous, here)) {
+                    supersede (*previous);
+                    lastRow.insert(b.ids[r], here);
+                } else {
+                    const QString n = name (k, r);
+                    const auto previousByName = collided.constFind(n);
+                    if (previousByName != collided.constEnd())
+                        supersede (*previousByName);
+                    collided.insert(n, here);
+                }
+            }
+        }
+        if (_NLiveRows == _NRows)
+            _Superseded.clear();
+    }
+    _Valid = true;
+}
+
+CoordinatesStore::CoordinatesStore(const QVector <row_t>& rows)
+    : _Valid (true) {
+    if (rows.isEmpty())
+        return;
+    // the names are the file names, so no row supersedes another one
+    _Memory = _Block (rows);
+    _AddBlock (reinterpret_cast <const uchar*> (_Memory.constData()));
+    _NLiveRows = _NRows;
+}
+
+void CoordinatesStore::_AddBlock(const uchar* block) {
+    block_t header;
+    memcpy (&header, block, sizeof (header));
+    const blockLayout_t l (header.nRows, header.namesSize);
+    _BlockView b;
+    b.nRows = header.nRows;
+    b.firstRow = _NRows;
+    b.ids = reinterpret_cast <const uint64_t*> (block + l.ids);
+    for (size_t c = 0; c < coordinates_t::nValues; ++c)
+        b.columns[c] = reinterpret_cast <const double*> (block + l.columns[c]);
+    b.nameOffsets = reinterpret_cast <const uint32_t*> (block + l.nameOffsets);
+    b.names = reinterpret_cast <const char*> (block + l.names);
+    _Blocks.append(b);
+    _NRows += b.nRows;
+}
+
+QString CoordinatesStore::name(int block, int row) const {
+    const _BlockView& b = _Blocks[block];
+    return QString::fromUtf8(b.names + b.nameOffsets[row],
+                             b.nameOffsets[row + 1] - b.nameOffsets[row]);
+}
+
+coordinates_t CoordinatesStore::coordinates(int block, int row) const {
+    coordinates_t ans;
+    for (size_t c = 0; c < coordinates_t::nValues; ++c)
+        ans.values[c] = _Blocks[block].columns[c][row];
+    return ans;
+}
+
+uint64_t CoordinatesStore::seriesId(const QString& name) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char c : name.toUtf8()) {
+        hash ^= static_cast <uint8_t> (c);
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+QString CoordinatesStore::path(const QDir& destDir) {
+    return destDir.absoluteFilePath(storeName);
+}
+
+bool CoordinatesStore::_Scan(const uchar* data, qint64 size, _Layout& layout) {
+    header_t header;
+    memcpy (&header, data, sizeof (header));
+    if (memcmp (header.magic, magic, sizeof (magic)) != 0
+        or header.version != currentVersion
+        or header.nColumns != coordinates_t::nValues)
+        return false;
+
+    // a row takes its id, its coordinates and the offset of its name at least
+    const uint64_t rowSize = sizeof (uint64_t) + coordinates_t::nValues * sizeof (double) + sizeof (uint32_t);
+    auto validBlock = [data, size, rowSize](uint64_t offset) {
+        block_t b;
+        if (offset % alignment != 0 or offset > static_cast <uint64_t> (size)
+            or sizeof (b) > static_cast <uint64_t> (size) - offset)
+            return uint64_t (0);
+        memcpy (&b, data + offset, sizeof (b));
+        // the counts are bound by the file before the layout is computed of them, so it doesn't wrap
+        const uint64_t left = static_cast <uint64_t> (size) - offset;
+        if (memcmp (b.magic, blockMagic, sizeof (blockMagic)) != 0
+            or b.nRows > left / rowSize or b.namesSize > left)
+            return uint64_t (0);
+        const blockLayout_t l (b.nRows, b.namesSize);
+        if (b.size != l.size or b.size > left)
+            return uint64_t (0);
+        // the names go one after another from the beginning to the end of their bytes
+        const uint32_t* nameOffsets = reinterpret_cast <const uint32_t*> (data + offset + l.nameOffsets);
+        if (nameOffsets[0] != 0 or nameOffsets[b.nRows] != b.namesSize)
+            return uint64_t (0);
+        for (uint32_t r = 0; r < b.nRows; ++r)
+            if (nameOffsets[r] > nameOffsets[r + 1])
+                return uint64_t (0);
+        return b.size;
+    };
+
+    // the footer lists the blocks, unless the last append was interrupted
+    layout.blocks.clear();
+    trailer_t trailer;
+    if (size >= static_cast <qint64> (firstBlock + sizeof (trailer))) {
+        memcpy (&trailer, data + size - sizeof (trailer), sizeof (trailer));
+        // the footer fills the file up to the trailer, checked piece by piece not to wrap
+        const uint64_t footerEnd = size - sizeof (trailer);
+        if (memcmp (trailer.magic, footerMagic, sizeof (footerMagic)) == 0
+            and trailer.footerOffset % sizeof (uint64_t) == 0 and trailer.footerOffset <= footerEnd
+            and trailer.nBlocks <= (footerEnd - trailer.footerOffset) / sizeof (uint64_t)
+            and trailer.footerOffset + trailer.nBlocks * sizeof (uint64_t) == footerEnd) {
+            const uint64_t* offsets = reinterpret_cast <const uint64_t*> (data + trailer.footerOffset);
+            uint64_t expected = firstBlock;
+            bool ok = true;
+            for (uint32_t i = 0; i < trailer.nBlocks and ok; ++i) {
+                const uint64_t blockSize = offsets[i] == expected ? validBlock (offsets[i]) : 0;
+                ok = blockSize > 0;
+                layout.blocks.append(offsets[i]);
+                expected += blockSize;
+            }
+            if (ok and expected == trailer.footerOffset) {
+                layout.end = trailer.footerOffset;
+                return true;
+            }
+            layout.blocks.clear();
+        }
+    }
+
+    // the blocks are contiguous, the whole ones are kept
+    uint64_t offset = firstBlock;
+    while (const uint64_t blockSize = validBlock (offset)) {
+        layout.blocks.append(offset);
+        offset += blockSize;
+    }
+    layout.end = offset;
+    return true;
+}
+
+QByteArray CoordinatesStore::_Block(const QVector <row_t>& rows) {
+    QVector <QByteArray> names;
+    names.reserve(rows.size());
+    uint64_t namesSize = 0;
+    for (const row_t& row : rows) {
+        names.append(row.name.toUtf8());
+        namesSize += names.last().size();
+    }
+
+    const int n = rows.size();
+    const blockLayout_t l (n, namesSize);
+    QByteArray ans (static_cast <int> (l.size), '\0');
+    char* data = ans.data();
+
+    block_t header;
+    memcpy (header.magic, blockMagic, sizeof (blockMagic));
+    header.nRows = n;
+    header.namesSize = namesSize;
+    header.size = l.size;
+    header.reserved = 0;
+    memcpy (data, &header, sizeof (header));
+
+    uint64_t* ids = reinterpret_cast <uint64_t*> (data + l.ids);
+    uint32_t* nameOffsets = reinterpret_cast <uint32_t*> (data + l.nameOffsets);
+    char* nameData = data + l.names;
+    uint32_t nameOffset = 0;
+    for (int r = 0; r < n; ++r) {
+        ids[r] = seriesId (rows[r].name);
+        for (size_t c = 0; c < coordinates_t::nValues; ++c)
+            reinterpret_cast <double*> (data + l.columns[c])[r] = rows[r].coordinates.values[c];
+        nameOffsets[r] = nameOffset;
+        memcpy (nameData + nameOffset, names[r].constData(), names[r].size());
+        nameOffset += names[r].size();
+    }
+    nameOffsets[n] = nameOffset;
+    return ans;
+}
+
+QByteArray CoordinatesStore::_Footer(const _Layout& layout) {
+    trailer_t trailer;
+    trailer.footerOffset = layout.end;
+    trailer.nBlocks = layout.blocks.size();
+    memcpy (trailer.magic, footerMagic, sizeof (footerMagic));
+
+    QByteArray ans (reinterpret_cast <const char*> (layout.blocks.constData()),
+                    layout.blocks.size() * sizeof (uint64_t));
+    ans.append(reinterpret_cast <const char*> (&trailer), sizeof (trailer));
+    return ans;
+}
+
+static QByteArray storeHeader () {
+    CoordinatesStore::header_t header;
+    memcpy (header.magic, magic, sizeof (magic));
+    header.version = CoordinatesStore::currentVersion;
+    header.nColumns = coordinates_t::nValues;
+    header.reserved = 0;
+    QByteArray ans (static_cast <int> (firstBlock), '\0');
+    memcpy (ans.data(), &header, sizeof (header));
+    return ans;
+}
+
+bool CoordinatesStore::append(const QString& fileName, const QVector <row_t>& rows) {
+    return rows.isEmpty() or Appender (fileName).append(rows);
+}
+
+CoordinatesStore::Appender::Appender(const QString& fileName)
+    : _File (fileName) {}
+
+bool CoordinatesStore::Appender::_Open() {
+    if (not _File.isOpen() and not _File.open(QIODevice::ReadWrite))
+        return false;
+
+    _Current = _Layout ();
+    const qint64 size = _File.size();
+    if (size == 0) {
+        if (not _File.seek(0) or _File.write(storeHeader ()) != static_cast <qint64> (firstBlock))
+            return false;
+        _Current.end = firstBlock;
+    } else {
+        uchar* data = size >= static_cast <qint64> (sizeof (header_t)) ? _File.map(0, size) : nullptr;
+        const bool ok = data and _Scan (data, size, _Current);
+        if (data)
+            _File.unmap(data);
+        if (not ok)
+            return false;
+    }
+    return true;
+}
+
+bool CoordinatesStore::Appender::append(const QVector <row_t>& rows) {
+    if (rows.isEmpty())
+        return true;
+    _Scanned = _Scanned or _Open ();
+    if (not _Scanned)
+        return false;
+
+    const QByteArray block = _Block (rows);
+    _Layout layout = _Current;
+    layout.blocks.append(layout.end);
+    layout.end += block.size();
+    const QByteArray footer = _Footer (layout);
+    // whatever has been written of a failed append, the file is scanned again
+    _Scanned = _File.seek(_Current.end)
+           and _File.write(block) == block.size()
+           and _File.write(footer) == footer.size()
+           and _File.resize(layout.end + footer.size())
+           and _File.flush();
+    if (_Scanned)
+        _Current = std::move (layout);
+    return _Scanned;
+}
+
+bool CoordinatesStore::_Write(const QString& fileName, const QVector <row_t>& rows) {
+    _Layout layout;
+    layout.end = firstBlock;
+    QByteArray data = storeHeader ();
+    if (not rows.isEmpty()) {
+        data.append(_Block (rows));
+        layout.blocks.append(firstBlock);
+        layout.end = data.size();
+    }
+    data.append(_Footer (layout));
+
+    QSaveFile file (fileName);
+    return file.open(QIODevice::WriteOnly)
+       and file.write(data) == data.size()
+       and file.commit();
+}
+
+bool CoordinatesStore::compact(const QString& fileName) {
+    QVector <row_t> rows;
+    {
+        const CoordinatesStore store (fileName);
+        if (not store.isValid())
+            return false;
+        if (store.nBlocks() <= 1)
+            return true;
+        rows.reserve(store.nLiveRows());
+        for (int b = 0; b < store.nBlocks(); ++b)
+            for (int r = 0; r < store.blockRows(b); ++r)
+                if (store.isLive(b, r))
+                    rows.append(row_t {store.name(b, r), store.coordinates(b, r)});
+    }
+    return _Write (fileName, rows);
+}
+
+QVector <CoordinatesStore::row_t> CoordinatesStore::readCoords(const QDir& destDir) {
+    const QStringList lst = destDir.entryList(QStringList() << "*.coords",
+                                              QDir::Readable | QDir::Files);
+    QVector <row_t> rows;
+    QStringList skipped;
+    rows.reserve(lst.size());
+    for (const QString& fname : lst) {
+        QFile file (destDir.filePath(fname));
+        if (not file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            skipped.append(fname);
+            continue;
+        }
+        QTextStream in (&file);
+        row_t row;
+        row.name = fname.left(fname.size() - static_cast <int> (strlen (".coords")));
+        // the files of the versions before the Lempel-Ziv complexities have no values for them
+        size_t nRead = 0;
+        for (; nRead < coordinates_t::nValues; ++nRead) {
+            double value;
+            in >> value;
+            if (in.status() != QTextStream::Ok)
+                break;
+            row.coordinates.values[nRead] = value;
+        }
+        std::fill (row.coordinates.values + nRead, std::end (row.coordinates.values),
+                   std::numeric_limits <double>::quiet_NaN());
+        // the empty files were left by the runs that failed on the series
+        if (nRead >= legacyValues)
+            rows.append(row);
+        else
+            skipped.append(fname);
+    }
+    if (not skipped.isEmpty())
+        qDebug () << "!!! skipped" << skipped.size() << "of" << lst.size()
+                  << ".coords files in" << destDir.absolutePath() << ":" << skipped.join(", ");
+    return rows;
+}
+
+bool CoordinatesStore::importCoords(const QDir& destDir) {
+    const QString storePath = path (destDir);
+    if (QFile::exists(storePath)
+        or destDir.entryList(QStringList() << "*.coords", QDir::Readable | QDir::Files).isEmpty())
+        return true;
+    return _Write (storePath, readCoords (destDir));
+}
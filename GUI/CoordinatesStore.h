@@ -0,0 +1,189 @@
+#ifndef COORDINATESSTORE_H_5e29c7b3_a04f_4d81_9c6e_37b8f02d1a94
+#define COORDINATESSTORE_H_5e29c7b3_a04f_4d81_9c6e_37b8f02d1a94
+
+#include <cstdint>
+
+#include <QDir>
+#include <QFile>
+#include <QVector>
+
+#include "Coordinates.h"
+#include "Span.h"
+
+/**
+ * @brief The coordinates of all the series of a set in one columnar file (.tsc), mapped into memory.
+ *
+ * The file is little-endian and consists of
+ *  - @c header_t;
+ *  - the blocks of rows, each one appended as a whole and never changed afterwards:
+ *    @c block_t, then @c block_t::nRows series ids, then a column of @c block_t::nRows doubles
+ *    per coordinate, then nRows + 1 offsets of the names and the names in UTF-8;
+ *    every block and every array in it starts at a multiple of @c alignment;
+ *  - the footer: the offsets of all the blocks;
+ *  - @c trailer_t pointing to the footer.
+ *
+ * An append writes a block over the old footer and a new footer after it, so the blocks
+ * written before a crash are found by walking them from the header if the footer is lost.
+ * A series appended again supersedes its older rows, found by the ids and then by the names,
+ * since two names may share an id; @c isLive tells the rows that count
+ * and @c compact drops the others, leaving all the columns contiguous in a single block.
+ */
+class CoordinatesStore {
+public:
+    static constexpr uint32_t currentVersion = 1;
+    static constexpr int alignment = 64;
+    /// The name of the store in the processed directory of a set
+    static constexpr const char* storeName = "coordinates.tsc";
+
+    struct header_t {
+        /// @c "TSC" followed by the byte 0x1a
+        char magic[4];
+        uint32_t version;
+        /// The number of the coordinate columns, @c coordinates_t::nValues
+        uint32_t nColumns;
+        uint32_t reserved;
+    };
+    struct block_t {
+        /// @c "TSCB"
+        char magic[4];
+        uint32_t nRows;
+        /// The size of the names in bytes
+        uint64_t namesSize;
+        /// The size of the whole block including the padding after it
+        uint64_t size;
+        uint64_t reserved;
+    };
+    struct trailer_t {
+        uint64_t footerOffset;
+        uint32_t nBlocks;
+        /// @c "TSCF"
+        char magic[4];
+    };
+
+    /// A row to append
+    struct row_t {
+        QString name;
+        coordinates_t coordinates;
+    };
+
+    /// Map the file; an absent file is a valid empty store, check @c isValid() otherwise
+    explicit CoordinatesStore (const QString& fileName);
+    /// A store of the @p rows in memory as a single block, e.g. of the .coords files of @c readCoords
+    explicit CoordinatesStore (const QVector <row_t>& rows);
+    CoordinatesStore (const CoordinatesStore&) = delete;
+    CoordinatesStore& operator= (const CoordinatesStore&) = delete;
+
+    bool isValid () const noexcept { return _Valid; }
+    /// How many rows there are, the superseded ones included
+    int nRows () const noexcept { return _NRows; }
+    /// How many rows count, i.e. how many series there are
+    int nLiveRows () const noexcept { return _NLiveRows; }
+
+    int nBlocks () const noexcept { return _Blocks.size(); }
+    int blockRows (int block) const { return _Blocks[block].nRows; }
+    /// The values of the coordinate @p coordinate in the @p block
+    Span <const double> column (int block, size_t coordinate) const {
+        const auto& b = _Blocks[block];
+        return Span <const double> (b.columns[coordinate], b.nRows);
+    }
+    Span <const uint64_t> ids (int block) const {
+        const auto& b = _Blocks[block];
+        return Span <const uint64_t> (b.ids, b.nRows);
+    }
+    QString name (int block, int row) const;
+    /// Whether the row is the last one of its series
+    bool isLive (int block, int row) const {
+        return _Superseded.isEmpty() or not _Superseded[_Blocks[block].firstRow + row];
+    }
+    coordinates_t coordinates (int block, int row) const;
+
+    /// The id of the series with the @p name: FNV-1a of its UTF-8
+    static uint64_t seriesId (const QString& name);
+
+    class Appender;
+    /// Append the @p rows as a new block, false on errors; see @c Appender for many appends
+    static bool append (const QString& fileName, const QVector <row_t>& rows);
+    /// Rewrite the store as a single block of the live rows, unless it is one already
+    static bool compact (const QString& fileName);
+    /**
+     * @brief read the .coords files of the older versions in the @p destDir.
+     *
+     * The older files of 10 values get NaN for the Lempel-Ziv complexities; the files
+     * that can't be read or have fewer values, e.g. the empty ones, are reported and skipped.
+     */
+    static QVector <row_t> readCoords (const QDir& destDir);
+    /**
+     * @brief make the store of the @p destDir out of its .coords files, if it has no store yet.
+     * @return false if the store could not be written
+     */
+    static bool importCoords (const QDir& destDir);
+    /// The store of the set processed into the @p destDir
+    static QString path (const QDir& destDir);
+
+private:
+    struct _BlockView {
+        int nRows;
+        int firstRow;
+        const uint64_t* ids;
+        const double* columns[coordinates_t::nValues];
+        const uint32_t* nameOffsets;
+        const char* names;
+    };
+    /// Where the appends go and the blocks found, see @c _Scan
+    struct _Layout {
+        QVector <uint64_t> blocks;
+        uint64_t end = 0;
+    };
+    /// Add the view of the valid block at @p block
+    void _AddBlock (const uchar* block);
+    /// Find the blocks of the mapped file of the @p size, false if it is no store
+    static bool _Scan (const uchar* data, qint64 size, _Layout& layout);
+    /// The block of the @p rows, the blocks start at multiples of @c alignment
+    static QByteArray _Block (const QVector <row_t>& rows);
+    /// The footer and the trailer for the @p layout
+    static QByteArray _Footer (const _Layout& layout);
+    /// Atomically replace the file with a store of a single block of the @p rows
+    static bool _Write (const QString& fileName, const QVector <row_t>& rows);
+
+    QFile _File;
+    /// The block of a store in memory
+    QByteArray _Memory;
+    bool _Valid = false;
+    int _NRows = 0;
+    int _NLiveRows = 0;
+    QVector <_BlockView> _Blocks;
+    /// By the row number over all the blocks, empty if no row is superseded
+    QVector <bool> _Superseded;
+};
+
+/**
+ * @brief The store kept open for the appends of a run.
+ *
+ * The file is scanned once rather than at every append, then each append writes
+ * its block and the footer by the layout kept; a failed append makes the next one
+ * scan the file again. Nothing else must write the store while it is open.
+ */
+class CoordinatesStore::Appender {
+public:
+    explicit Appender (const QString& fileName);
+    Appender (const Appender&) = delete;
+    Appender& operator= (const Appender&) = delete;
+
+    /// Append the @p rows as a new block, false on errors
+    bool append (const QVector <row_t>& rows);
+    /// Close the file, e.g. before it is compacted
+    void close () {
+        _File.close();
+        _Scanned = false;
+    }
+
+private:
+    /// Open the file and find its blocks, false if it is no store
+    bool _Open ();
+
+    QFile _File;
+    bool _Scanned = false;
+    _Layout _Current;
+};
+
+#endif // COORDINATESSTORE_H
@@ -0,0 +1,68 @@
+# The analysis with no user interface, shared by the GUI and the command line tool.
+# It needs QtCore only.
+
+#CONFIG   += c++14
+QMAKE_CXXFLAGS += -std=c++1y
+DEFINES  += _USE_MATH_DEFINES
+LIBS     += -llzma -lz
+INCLUDEPATH += $$PWD
+
+SOURCES += \
+    $$PWD/TimeSeries.cc \
+    $$PWD/Fourier.cc \
+    $$PWD/SeriesBatch.cc \
+    $$PWD/WordCounter.cc \
+    $$PWD/SuffixArray.cc \
+    $$PWD/SeriesKernels.cc \
+    $$PWD/Hurst.cc \
+    $$PWD/NumberParser.cc \
+    $$PWD/SeriesFile.cc \
+    $$PWD/DeviationRange.cc \
+    $$PWD/WordStatistics.cc \
+    $$PWD/SlidingAnalysis.cc \
+    $$PWD/LzmaEncoder.cc \
+    $$PWD/Compressor.cc \
+    $$PWD/DeflateEncoder.cc \
+    $$PWD/Lz77Encoder.cc \
+    $$PWD/PpmEncoder.cc \
+    $$PWD/TaskPool.cc \
+    $$PWD/AnalysisEngine.cc \
+    $$PWD/Coordinates.cc \
+    $$PWD/Generator.cc \
+    $$PWD/CoordinatesStore.cc \
+    $$PWD/Manifest.cc \
+    $$PWD/MetricCache.cc \
+    $$PWD/CoMoments.cc \
+    $$PWD/CovarianceKernel.cc \
+    $$PWD/RankCorrelation.cc
+
+HEADERS += \
+    $$PWD/TimeSeries.h \
+    $$PWD/Fourier.h \
+    $$PWD/SeriesBatch.h \
+    $$PWD/WordCounter.h \
+    $$PWD/SuffixArray.h \
+    $$PWD/SeriesKernels.h \
+    $$PWD/Hurst.h \
+    $$PWD/NumberParser.h \
+    $$PWD/SeriesFile.h \
+    $$PWD/DeviationRange.h \
+    $$PWD/WordStatistics.h \
+    $$PWD/SlidingAnalysis.h \
+    $$PWD/LzmaEncoder.h \
+    $$PWD/Compressor.h \
+    $$PWD/DeflateEncoder.h \
+    $$PWD/Lz77Encoder.h \
+    $$PWD/PpmEncoder.h \
+    $$PWD/TaskPool.h \
+    $$PWD/AnalysisEngine.h \
+    $$PWD/Coordinates.h \
+    $$PWD/Generator.h \
+    $$PWD/CoordinatesStore.h \
+    $$PWD/MpscQueue.h \
+    $$PWD/Manifest.h \
+    $$PWD/MetricCache.h \
+    $$PWD/CoMoments.h \
+    $$PWD/CovarianceKernel.h \
+    $$PWD/RankCorrelation.h \
+    $$PWD/Span.h
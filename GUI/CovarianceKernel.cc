@@ -0,0 +1,270 @@
+#include "CovarianceKernel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined (__GNUC__) and (defined (__x86_64__) or defined (__i386__))
+#include <immintrin.h>
+#endif
+
+void comoments_t::add(double x, double y) noexcept {
+    n += 1.;
+    const double dx = x - meanX,
+                 dy = y - meanY;
+    meanX += dx / n;
+    meanY += dy / n;
+    m2X += dx * (x - meanX);
+    m2Y += dy * (y - meanY);
+    c += dx * (y - meanY);
+}
+
+void comoments_t::merge(const comoments_t& other) noexcept {
+    if (other.n == 0.)
+        return;
+    if (n == 0.) {
+        *this = other;
+        return;
+    }
+    const double total = n + other.n,
+                 dx = other.meanX - meanX,
+                 dy = other.meanY - meanY,
+                 w = n * other.n / total;
+    meanX += dx * other.n / total;
+    meanY += dy * other.n / total;
+    m2X += other.m2X + dx * dx * w;
+    m2Y += other.m2Y + dy * dy * w;
+    c += other.c + dx * dy * w;
+    n = total;
+}
+
+void comoments_t::remove(const comoments_t& other) noexcept {
+    if (other.n == 0.)
+        return;
+    const double rest = n - other.n;
+    if (rest <= 0.) {
+        *this = comoments_t ();
+        return;
+    }
+    // this was merged of the rest and the other
+    const double restX = (n * meanX - other.n * other.meanX) / rest,
+                 restY = (n * meanY - other.n * other.meanY) / rest,
+                 dx = other.meanX - restX,
+                 dy = other.meanY - restY,
+                 w = rest * other.n / n;
+    // the rounding must not make a variance negative
+    m2X = std::max (0., m2X - other.m2X - dx * dx * w);
+    m2Y = std::max (0., m2Y - other.m2Y - dy * dy * w);
+    c -= other.c + dx * dy * w;
+    meanX = restX;
+    meanY = restY;
+    n = rest;
+}
+
+namespace {
+/// Rows per block: the three arrays of all the columns of a block stay in L2
+constexpr int blockRows = 256;
+
+/// The sums over a block of a pair i, j of the masked values x, their squares q and the masks m
+struct sums_t {
+    double n, x, y, xx, yy, xy;
+};
+
+void pairSumsScalar (const double* xi, const double* qi, const double* mi,
+                     const double* xj, const double* qj, const double* mj,
+                     int begin, int end, sums_t& s) {
+    for (int r = begin; r < end; ++r) {
+        s.n += mi[r] * mj[r];
+        s.x += xi[r] * mj[r];
+        s.y += xj[r] * mi[r];
+        s.xx += qi[r] * mj[r];
+        s.yy += qj[r] * mi[r];
+        s.xy += xi[r] * xj[r];
+    }
+}
+
+double dotScalar (const double* a, const double* b, int begin, int end) {
+    double s = 0.;
+    for (int r = begin; r < end; ++r)
+        s += a[r] * b[r];
+    return s;
+}
+
+#ifdef __SSE2__
+double dot (const double* a, const double* b, int n) {
+    // two accumulators hide the latency of the additions
+    __m128d s0 = _mm_setzero_pd(), s1 = s0;
+    int r = 0;
+    for (; r + 4 <= n; r += 4) {
+        s0 = _mm_add_pd(s0, _mm_mul_pd(_mm_loadu_pd(a + r), _mm_loadu_pd(b + r)));
+        s1 = _mm_add_pd(s1, _mm_mul_pd(_mm_loadu_pd(a + r + 2), _mm_loadu_pd(b + r + 2)));
+    }
+    alignas (16) double p[2];
+    _mm_store_pd(p, _mm_add_pd(s0, s1));
+    return p[0] + p[1] + dotScalar (a, b, r, n);
+}
+
+sums_t pairSums (const double* xi, const double* qi, const double* mi,
+                 const double* xj, const double* qj, const double* mj, int n) {
+    __m128d n2 = _mm_setzero_pd(), x2 = n2, y2 = n2, xx2 = n2, yy2 = n2, xy2 = n2;
+    int r = 0;
+    for (; r + 2 <= n; r += 2) {
+        const __m128d a = _mm_loadu_pd(xi + r), qa = _mm_loadu_pd(qi + r), ma = _mm_loadu_pd(mi + r),
+                      b = _mm_loadu_pd(xj + r), qb = _mm_loadu_pd(qj + r), mb = _mm_loadu_pd(mj + r);
+        n2 = _mm_add_pd(n2, _mm_mul_pd(ma, mb));
+        x2 = _mm_add_pd(x2, _mm_mul_pd(a, mb));
+        y2 = _mm_add_pd(y2, _mm_mul_pd(b, ma));
+        xx2 = _mm_add_pd(xx2, _mm_mul_pd(qa, mb));
+        yy2 = _mm_add_pd(yy2, _mm_mul_pd(qb, ma));
+        xy2 = _mm_add_pd(xy2, _mm_mul_pd(a, b));
+    }
+    alignas (16) double p[6][2];
+    _mm_store_pd(p[0], n2);
+    _mm_store_pd(p[1], x2);
+    _mm_store_pd(p[2], y2);
+    _mm_store_pd(p[3], xx2);
+    _mm_store_pd(p[4], yy2);
+    _mm_store_pd(p[5], xy2);
+    sums_t s {p[0][0] + p[0][1], p[1][0] + p[1][1], p[2][0] + p[2][1],
+              p[3][0] + p[3][1], p[4][0] + p[4][1], p[5][0] + p[5][1]};
+    pairSumsScalar (xi, qi, mi, xj, qj, mj, r, n, s);
+    return s;
+}
+#else
+double dot (const double* a, const double* b, int n) {
+    return dotScalar (a, b, 0, n);
+}
+
+sums_t pairSums (const double* xi, const double* qi, const double* mi,
+                 const double* xj, const double* qj, const double* mj, int n) {
+    sums_t s {0., 0., 0., 0., 0., 0.};
+    pairSumsScalar (xi, qi, mi, xj, qj, mj, 0, n, s);
+    return s;
+}
+#endif
+
+#if defined (__GNUC__) and (defined (__x86_64__) or defined (__i386__))
+#define HAVE_AVX2_DISPATCH
+
+bool hasAvx2() {
+    static const bool ans = __builtin_cpu_supports("avx2");
+    return ans;
+}
+
+__attribute__ ((target ("avx2")))
+inline double horizontalSum (__m256d v) {
+    const __m128d s = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(s, _mm_unpackhi_pd(s, s)));
+}
+
+__attribute__ ((target ("avx2")))
+double dotAvx2 (const double* a, const double* b, int n) {
+    __m256d s0 = _mm256_setzero_pd(), s1 = s0;
+    int r = 0;
+    for (; r + 8 <= n; r += 8) {
+        s0 = _mm256_add_pd(s0, _mm256_mul_pd(_mm256_loadu_pd(a + r), _mm256_loadu_pd(b + r)));
+        s1 = _mm256_add_pd(s1, _mm256_mul_pd(_mm256_loadu_pd(a + r + 4), _mm256_loadu_pd(b + r + 4)));
+    }
+    return horizontalSum (_mm256_add_pd(s0, s1)) + dotScalar (a, b, r, n);
+}
+
+__attribute__ ((target ("avx2")))
+sums_t pairSumsAvx2 (const double* xi, const double* qi, const double* mi,
+                     const double* xj, const double* qj, const double* mj, int n) {
+    __m256d n4 = _mm256_setzero_pd(), x4 = n4, y4 = n4, xx4 = n4, yy4 = n4, xy4 = n4;
+    int r = 0;
+    for (; r + 4 <= n; r += 4) {
+        const __m256d a = _mm256_loadu_pd(xi + r), qa = _mm256_loadu_pd(qi + r), ma = _mm256_loadu_pd(mi + r),
+                      b = _mm256_loadu_pd(xj + r), qb = _mm256_loadu_pd(qj + r), mb = _mm256_loadu_pd(mj + r);
+        n4 = _mm256_add_pd(n4, _mm256_mul_pd(ma, mb));
+        x4 = _mm256_add_pd(x4, _mm256_mul_pd(a, mb));
+        y4 = _mm256_add_pd(y4, _mm256_mul_pd(b, ma));
+        xx4 = _mm256_add_pd(xx4, _mm256_mul_pd(qa, mb));
+        yy4 = _mm256_add_pd(yy4, _mm256_mul_pd(qb, ma));
+        xy4 = _mm256_add_pd(xy4, _mm256_mul_pd(a, b));
+    }
+    sums_t s {horizontalSum (n4), horizontalSum (x4), horizontalSum (y4),
+              horizontalSum (xx4), horizontalSum (yy4), horizontalSum (xy4)};
+    pairSumsScalar (xi, qi, mi, xj, qj, mj, r, n, s);
+    return s;
+}
+#endif
+}
+
+void accumulateComoments(const double* const* columns, int nColumns, int nRows,
+                         const uint8_t* live, comoments_t* pairs) {
+    // the masked values shifted by the block means, their squares and the masks, by columns
+    std::vector <double> x (nColumns * blockRows), q (x.size()), m (x.size()), shift (nColumns);
+    // the sums of the columns having all the rows of a block, for the pairs of them
+    std::vector <double> sumX (nColumns), sumQ (nColumns);
+    std::vector <uint8_t> full (nColumns);
+    for (int begin = 0; begin < nRows; begin += blockRows) {
+        const int n = std::min (blockRows, nRows - begin);
+
+        for (int c = 0; c < nColumns; ++c) {
+            const double* v = columns[c] + begin;
+            double* xc = x.data() + c * blockRows;
+            double* qc = q.data() + c * blockRows;
+            double* mc = m.data() + c * blockRows;
+            double sum = 0.;
+            int count = 0;
+            for (int r = 0; r < n; ++r) {
+                const bool valid = not std::isnan (v[r]) and (not live or live[begin + r]);
+                mc[r] = valid ? 1. : 0.;
+                sum += valid ? v[r] : 0.;
+                count += valid;
+            }
+            // the values near 0 keep the sums of the squares from cancelling out
+            shift[c] = count > 0 ? sum / count : 0.;
+            sumX[c] = sumQ[c] = 0.;
+            for (int r = 0; r < n; ++r) {
+                xc[r] = mc[r] != 0. ? v[r] - shift[c] : 0.;
+                qc[r] = xc[r] * xc[r];
+                sumX[c] += xc[r];
+                sumQ[c] += qc[r];
+            }
+            full[c] = count == n;
+        }
+
+        for (int i = 0; i < nColumns; ++i) {
+            const double* xi = x.data() + i * blockRows;
+            const double* qi = q.data() + i * blockRows;
+            const double* mi = m.data() + i * blockRows;
+            for (int j = i; j < nColumns; ++j) {
+                const double* xj = x.data() + j * blockRows;
+                const double* qj = q.data() + j * blockRows;
+                const double* mj = m.data() + j * blockRows;
+                sums_t s;
+                if (full[i] and full[j]) {
+                    // the usual case: no mask, only the products are left
+#ifdef HAVE_AVX2_DISPATCH
+                    const double xy = hasAvx2() ? dotAvx2 (xi, xj, n) : dot (xi, xj, n);
+#else
+                    const double xy = dot (xi, xj, n);
+#endif
+                    s = sums_t {static_cast <double> (n), sumX[i], sumX[j], sumQ[i], sumQ[j], xy};
+                } else {
+#ifdef HAVE_AVX2_DISPATCH
+                    s = hasAvx2() ? pairSumsAvx2 (xi, qi, mi, xj, qj, mj, n)
+                                  : pairSums (xi, qi, mi, xj, qj, mj, n);
+#else
+                    s = pairSums (xi, qi, mi, xj, qj, mj, n);
+#endif
+                }
+                if (s.n == 0.)
+                    continue;
+                comoments_t block;
+                block.n = s.n;
+                block.meanX = shift[i] + s.x / s.n;
+                block.meanY = shift[j] + s.y / s.n;
+                block.m2X = std::max (0., s.xx - s.x * s.x / s.n);
+                block.m2Y = std::max (0., s.yy - s.y * s.y / s.n);
+                block.c = s.xy - s.x * s.y / s.n;
+                pairs[pairIndex (i, j, nColumns)].merge(block);
+            }
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef COVARIANCEKERNEL_H_71c4e0a9_3b5d_4f28_96ea_0d8f2b6c5e13
+#define COVARIANCEKERNEL_H_71c4e0a9_3b5d_4f28_96ea_0d8f2b6c5e13
+
+#include <cstddef>
+#include <cstdint>
+
+/// The co-moments of a pair of columns over the rows where both of them are not NaN
+struct comoments_t {
+    double n = 0.;
+    double meanX = 0., meanY = 0.;
+    /// The sums of the squared deviations from the means
+    double m2X = 0., m2Y = 0.;
+    /// The sum of the products of the deviations
+    double c = 0.;
+
+    /// Fold in one row
+    void add (double x, double y) noexcept;
+    /// Fold in the rows of @p other, none of them must be here (Chan et al.)
+    void merge (const comoments_t& other) noexcept;
+    /// Take out the rows of @p other, all of them must be here
+    void remove (const comoments_t& other) noexcept;
+};
+
+/// The number of the pair i ≤ j of @p nColumns columns in the upper triangle by rows
+inline size_t pairIndex (size_t i, size_t j, size_t nColumns) noexcept {
+    return i * nColumns - i * (i + 1) / 2 + j;
+}
+
+/**
+ * @brief fold @p nRows rows of @p nColumns columns into the co-moments of all the pairs of columns.
+ *
+ * The rows go by blocks: each column of a block is shifted by its mean and masked
+ * by its validity, then the counts and the sums of all the pairs, the whole
+ * X̃ᵀ·M, Mᵀ·M and X̃ᵀ·X̃ of the block, are taken in one sweep over the block
+ * and merged into @p pairs. The sums are vectorized by SSE2 where the compiler
+ * targets it, by AVX2 if the processor has it and the compiler is GCC or Clang.
+ * @param columns the columns, NaN where the value is missing
+ * @param live the rows to count, nullptr for all of them
+ * @param pairs nColumns × (nColumns + 1) / 2 co-moments by @c pairIndex
+ */
+void accumulateComoments (const double* const* columns, int nColumns, int nRows,
+                          const uint8_t* live, comoments_t* pairs);
+
+#endif // COVARIANCEKERNEL_H
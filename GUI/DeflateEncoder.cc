@@ -0,0 +1,61 @@
+#include "DeflateEncoder.h"
+
+#include <climits>
+
+#include <zlib.h>
+
+struct DeflateEncoder::stream_t {
+    z_stream stream;
+    bool initialized = false;
+    /// The level the stream is initialized with
+    int level = 0;
+    /// The compressed data are written here and dropped
+    Bytef output[1 << 16];
+
+    ~stream_t () {
+        if (initialized)
+            deflateEnd (&stream);
+    }
+};
+
+DeflateEncoder::DeflateEncoder()
+    : _Stream (new stream_t) {
+}
+
+DeflateEncoder::~DeflateEncoder() = default;
+
+qint64 DeflateEncoder::compressedSize(const void* data, qint64 size) {
+    z_stream& stream = _Stream->stream;
+    if (not _Stream->initialized) {
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        if (deflateInit (&stream, _Level) != Z_OK)
+            return -1;
+        _Stream->initialized = true;
+    } else if (deflateReset(&stream) != Z_OK
+               or (_Stream->level != _Level
+                   and deflateParams(&stream, _Level, Z_DEFAULT_STRATEGY) != Z_OK)) {
+        return -1;
+    }
+    _Stream->level = _Level;
+
+    auto next = static_cast <const Bytef*> (data);
+    qint64 left = size;
+    stream.avail_in = 0;
+    int ret;
+    do {
+        // avail_in is 32 bits wide
+        const uInt chunk = left < UINT_MAX ? left : UINT_MAX;
+        if (stream.avail_in == 0) {
+            stream.next_in = const_cast <Bytef*> (next);
+            stream.avail_in = chunk;
+            next += chunk;
+            left -= chunk;
+        }
+        stream.next_out = _Stream->output;
+        stream.avail_out = sizeof (_Stream->output);
+        ret = deflate(&stream, left == 0 ? Z_FINISH : Z_NO_FLUSH);
+    } while (ret == Z_OK or ret == Z_BUF_ERROR);
+    return ret == Z_STREAM_END ? static_cast <qint64> (stream.total_out) : -1;
+}
@@ -0,0 +1,24 @@
+#ifndef DEFLATEENCODER_H_a84f2c19_6e07_4d3b_95a1_c7e05b8d3f62
+#define DEFLATEENCODER_H_a84f2c19_6e07_4d3b_95a1_c7e05b8d3f62
+
+#include "Compressor.h"
+
+/**
+ * @brief The deflate encoder of zlib working in memory.
+ *
+ * The output is the zlib format with its 6 bytes of the header and the checksum.
+ * The level is the zlib one, the stream is reset rather than reallocated for the next data.
+ */
+class DeflateEncoder : public Compressor {
+public:
+    DeflateEncoder ();
+    ~DeflateEncoder ();
+
+    qint64 compressedSize (const void* data, qint64 size) override;
+
+private:
+    struct stream_t;
+    std::unique_ptr <stream_t> _Stream;
+};
+
+#endif // DEFLATEENCODER_H
@@ -0,0 +1,53 @@
+#include "DeviationRange.h"
+
+void DeviationRange::clear() {
+    _Size = 0;
+    _Shift = _Sum = 0.;
+    _Upper.clear();
+    _Lower.clear();
+}
+
+void DeviationRange::add(double value) {
+    if (_Size == 0)
+        _Shift = value;
+    ++_Size;
+    _Sum += value - _Shift;
+    _Push (_Upper, point_t {static_cast <double> (_Size), _Sum});
+    _Push (_Lower, point_t {static_cast <double> (_Size), -_Sum});
+}
+
+double DeviationRange::range(double mean) const {
+    if (_Size == 0)
+        return 0.;
+    const double a = mean - _Shift;
+    // min (S_k - k·a) = -max (-S_k - k·(-a))
+    return _Max (_Upper, a) + _Max (_Lower, -a);
+}
+
+void DeviationRange::_Push(QVector <point_t>& hull, point_t p) {
+    // drop the vertices that are not above the chord from their predecessor to p
+    while (hull.size() >= 2) {
+        const point_t& o = hull[hull.size() - 2];
+        const point_t& a = hull.last();
+        if ((a.k - o.k) * (p.s - o.s) - (a.s - o.s) * (p.k - o.k) < 0)
+            break;
+        hull.removeLast();
+    }
+    hull.append(p);
+}
+
+double DeviationRange::_Max(const QVector <point_t>& hull, double slope) {
+    // The edge slopes decrease along the chain, s - k·slope grows
+    // while they are above the given one.
+    int lo = 0, hi = hull.size() - 1;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        const point_t& a = hull[mid];
+        const point_t& b = hull[mid + 1];
+        if (b.s - a.s > slope * (b.k - a.k))
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return hull[lo].s - hull[lo].k * slope;
+}
@@ -0,0 +1,44 @@
+#ifndef DEVIATIONRANGE_H_91c4a7e2_6b3d_4f08_a5e9_2d7f18c0b643
+#define DEVIATIONRANGE_H_91c4a7e2_6b3d_4f08_a5e9_2d7f18c0b643
+
+#include <QVector>
+
+/**
+ * @brief The range of the cumulative deviations of a growing series from any mean.
+ *
+ * The cumulative deviation after k values is S_k - k·a, where S_k is the sum
+ * of the first k values and a is the mean. Its maximum over k is reached
+ * at a vertex of the upper convex hull of the points (k, S_k), the minimum
+ * at a vertex of the lower one. The points come with increasing k,
+ * so both hulls are kept by the monotone chain in amortized O(1) per point
+ * and a query for the current mean takes O(log h) for h hull vertices.
+ */
+class DeviationRange {
+public:
+    void clear ();
+    /// How many values have been added
+    int size () const noexcept { return _Size; }
+
+    /// Add the next value
+    void add (double value);
+
+    /// max - min of the cumulative deviations from @p mean over k = 1..size()
+    double range (double mean) const;
+
+private:
+    struct point_t {
+        double k, s;
+    };
+    /// Add the point to the upper convex chain @p hull
+    static void _Push (QVector <point_t>& hull, point_t p);
+    /// max of s - k·slope over the vertices of the upper convex chain @p hull
+    static double _Max (const QVector <point_t>& hull, double slope);
+
+    int _Size = 0;
+    /// The sums are taken of the values minus the first one, to keep them small
+    double _Shift = 0., _Sum = 0.;
+    /// The upper hull of (k, S_k) and the upper hull of (k, -S_k), i.e. the lower one upside down
+    QVector <point_t> _Upper, _Lower;
+};
+
+#endif // DEVIATIONRANGE_H
@@ -0,0 +1,201 @@
+#include "Fourier.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <list>
+#include <mutex>
+#include <type_traits>
+
+namespace {
+using complex = ComplexFFT::complex;
+
+/// std::complex multiplication checks for NaNs and infinities, which is too slow here
+inline complex mul (complex a, complex b) {
+    return complex (a.real() * b.real() - a.imag() * b.imag(),
+                    a.real() * b.imag() + a.imag() * b.real());
+}
+
+inline complex unit (double angle) {
+    return complex (cos (angle), sin (angle));
+}
+
+/// How many plans of different lengths to keep
+constexpr size_t planCacheSize = 16;
+}
+
+ComplexFFT::ComplexFFT(int n) : _N (n), _PowerOf2 (n > 0 and (n & (n - 1)) == 0) {
+    assert (n > 0);
+    if (_PowerOf2) {
+        int bits = 0;
+        while ((1 << bits) < n)
+            ++bits;
+        _Reversed.resize(n);
+        for (int i = 0; i < n; ++i) {
+            int r = 0;
+            for (int b = 0; b < bits; ++b)
+                if (i & (1 << b))
+                    r |= 1 << (bits - 1 - b);
+            _Reversed[i] = r;
+        }
+        _Twiddles.resize(n / 2);
+        for (int j = 0; j < n / 2; ++j)
+            _Twiddles[j] = unit (-2 * M_PI * j / n);
+        return;
+    }
+
+    int L = 1;
+    while (L < 2 * n - 1)
+        L <<= 1;
+    _Convolution.reset(new ComplexFFT (L));
+
+    _Chirp.resize(n);
+    const long long period = 2ll * n;
+    for (long long j = 0; j < n; ++j)
+        // j² is reduced modulo 2n to keep the angle small and precise
+        _Chirp[j] = unit (-M_PI * static_cast <double> (j * j % period) / n);
+
+    _ChirpSpectrum.assign(L, complex (0., 0.));
+    _ChirpSpectrum[0] = std::conj (_Chirp[0]);
+    for (int j = 1; j < n; ++j)
+        _ChirpSpectrum[j] = _ChirpSpectrum[L - j] = std::conj (_Chirp[j]);
+    _Convolution->transform(_ChirpSpectrum.data());
+}
+
+namespace {
+using oneLane = std::integral_constant <int, 1>;
+}
+
+void ComplexFFT::transform(complex* data) const {
+    _Transform(data, oneLane ());
+}
+
+void ComplexFFT::transform(complex* data, int nLanes) const {
+    _Transform(data, nLanes);
+}
+
+template <typename lanes_t>
+void ComplexFFT::_Transform(complex* data, lanes_t nLanes) const {
+    if (_PowerOf2)
+        _Radix2(data, nLanes);
+    else
+        _Bluestein(data, nLanes);
+}
+
+template <typename lanes_t>
+void ComplexFFT::_Radix2(complex* a, lanes_t nLanes) const {
+    const int n = _N;
+    for (int i = 0; i < n; ++i) {
+        int j = _Reversed[i];
+        if (i < j)
+            std::swap_ranges (a + i * nLanes, a + (i + 1) * nLanes, a + j * nLanes);
+    }
+
+    for (int len = 2; len <= n; len <<= 1) {
+        const int half = len / 2,
+                  step = n / len;
+        for (int i = 0; i < n; i += len) {
+            for (int j = 0; j < half; ++j) {
+                complex* x = a + (i + j) * nLanes;
+                complex* y = x + half * nLanes;
+                for (int s = 0; s < nLanes; ++s) {
+                    complex u = x[s],
+                            v = mul (y[s], _Twiddles[j * step]);
+                    x[s] = u + v;
+                    y[s] = u - v;
+                }
+            }
+        }
+    }
+}
+
+template <typename lanes_t>
+void ComplexFFT::_Bluestein(complex* data, lanes_t nLanes) const {
+    const int n = _N,
+              L = _Convolution->size();
+    thread_local std::vector <complex> work;
+    work.assign(static_cast <size_t> (L) * nLanes, complex (0., 0.));
+
+    for (int j = 0; j < n; ++j)
+        for (int s = 0; s < nLanes; ++s)
+            work[j * nLanes + s] = mul (data[j * nLanes + s], _Chirp[j]);
+    _Convolution->_Radix2(work.data(), nLanes);
+
+    // inverse transform as conj (FFT (conj (x))) / L
+    for (int k = 0; k < L; ++k)
+        for (int s = 0; s < nLanes; ++s)
+            work[k * nLanes + s] = std::conj (mul (work[k * nLanes + s], _ChirpSpectrum[k]));
+    _Convolution->_Radix2(work.data(), nLanes);
+
+    for (int k = 0; k < n; ++k)
+        for (int s = 0; s < nLanes; ++s)
+            data[k * nLanes + s] = mul (std::conj (work[k * nLanes + s]), _Chirp[k]) / static_cast <double> (L);
+}
+
+RealFFT::RealFFT(int n) : _N (n), _Packed (n % 2 ? n : n / 2) {
+    if (n % 2)
+        return;
+    _Twiddles.resize(n / 2 + 1);
+    for (int k = 0; k <= n / 2; ++k)
+        _Twiddles[k] = unit (-2 * M_PI * k / n);
+}
+
+std::shared_ptr <const RealFFT> RealFFT::plan(int n) {
+    static std::mutex mutex;
+    /// most recently used plans go first
+    static std::list <std::shared_ptr <const RealFFT>> cache;
+
+    std::lock_guard <std::mutex> lock (mutex);
+    for (auto i = cache.begin(); i != cache.end(); ++i) {
+        if ((*i)->size() == n) {
+            cache.splice(cache.begin(), cache, i);
+            return cache.front();
+        }
+    }
+
+    cache.push_front(std::make_shared <const RealFFT> (n));
+    if (cache.size() > planCacheSize)
+        cache.pop_back();
+    return cache.front();
+}
+
+void RealFFT::transform(const double* in, complex* out) const {
+    _Transform(in, out, oneLane ());
+}
+
+void RealFFT::transform(const double* in, complex* out, int nLanes) const {
+    _Transform(in, out, nLanes);
+}
+
+template <typename lanes_t>
+void RealFFT::_Transform(const double* in, complex* out, lanes_t nLanes) const {
+    const int n = _N;
+    thread_local std::vector <complex> work;
+
+    if (n % 2) {
+        work.resize(static_cast <size_t> (n) * nLanes);
+        for (int j = 0; j < n * nLanes; ++j)
+            work[j] = complex (in[j], 0.);
+        _Packed._Transform(work.data(), nLanes);
+        std::copy (work.begin(), work.begin() + (n / 2 + 1) * nLanes, out);
+        return;
+    }
+
+    // even and odd samples are packed into the real and imaginary parts
+    const int h = n / 2;
+    work.resize(static_cast <size_t> (h) * nLanes);
+    for (int j = 0; j < h; ++j)
+        for (int s = 0; s < nLanes; ++s)
+            work[j * nLanes + s] = complex (in[2 * j * nLanes + s], in[(2 * j + 1) * nLanes + s]);
+    _Packed._Transform(work.data(), nLanes);
+
+    for (int k = 0; k <= h; ++k) {
+        const complex* z = work.data() + (k % h) * nLanes;
+        const complex* zc = work.data() + ((h - k) % h) * nLanes;
+        for (int s = 0; s < nLanes; ++s) {
+            const complex even = (z[s] + std::conj (zc[s])) * .5,
+                          odd = mul (z[s] - std::conj (zc[s]), complex (0., -.5));
+            out[k * nLanes + s] = even + mul (_Twiddles[k], odd);
+        }
+    }
+}
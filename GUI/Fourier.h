@@ -0,0 +1,103 @@
+#ifndef FOURIER_H_322d2713_5b01_491c_88fc_04ae07ed67e5
+#define FOURIER_H_322d2713_5b01_491c_88fc_04ae07ed67e5
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Fast discrete Fourier transform of a complex sequence of any length.
+ *
+ * Powers of two are handled by the iterative radix-2 algorithm,
+ * any other length is reduced to a power-of-two convolution (Bluestein).
+ * The object is immutable after construction, so it may be shared between threads.
+ *
+ * Several sequences of the same length may be transformed at once interleaved,
+ * the element j of the sequence s at j·nLanes + s: every butterfly then runs
+ * over the lanes with the same twiddle, and the results are the same as one by one.
+ */
+class ComplexFFT {
+public:
+    using complex = std::complex <double>;
+
+    explicit ComplexFFT (int n);
+
+    int size () const noexcept { return _N; }
+
+    /// In-place forward transform: X_k = Σ x_j exp(-2πi·jk/n)
+    void transform (complex* data) const;
+    /// The same for @p nLanes interleaved sequences
+    void transform (complex* data, int nLanes) const;
+
+private:
+    friend class RealFFT;
+
+    /**
+     * The transforms of @p nLanes sequences, either an int or a compile-time constant,
+     * so that the loops over the lanes vanish for a single one
+     */
+    template <typename lanes_t>
+    void _Transform (complex* data, lanes_t nLanes) const;
+    /// radix-2 transform of @p data, the length must be _N and a power of 2
+    template <typename lanes_t>
+    void _Radix2 (complex* data, lanes_t nLanes) const;
+    /// Bluestein transform for an arbitrary _N
+    template <typename lanes_t>
+    void _Bluestein (complex* data, lanes_t nLanes) const;
+
+    int _N;
+    bool _PowerOf2;
+
+    /// bit-reversal permutation for the radix-2 case
+    std::vector <int> _Reversed;
+    /// exp(-2πi·j/n) for j < n/2 for the radix-2 case
+    std::vector <complex> _Twiddles;
+
+    /// exp(-πi·j²/n), the Bluestein chirp
+    std::vector <complex> _Chirp;
+    /// the spectrum of the conjugated chirp, padded to _Convolution->size()
+    std::vector <complex> _ChirpSpectrum;
+    /// power-of-2 transform used for the Bluestein convolution
+    std::unique_ptr <ComplexFFT> _Convolution;
+};
+
+/**
+ * @brief Fast discrete Fourier transform of real-valued data.
+ *
+ * For even lengths the data are packed into a complex sequence of the half length,
+ * so the transform costs about as much as a complex one of n/2 points.
+ *
+ * Plans are expensive to build and are cached per length:
+ * use @c RealFFT::plan instead of constructing them.
+ */
+class RealFFT {
+public:
+    using complex = ComplexFFT::complex;
+
+    /// Get a (probably cached) plan for real sequences of length @p n > 0
+    static std::shared_ptr <const RealFFT> plan (int n);
+
+    explicit RealFFT (int n);
+
+    int size () const noexcept { return _N; }
+
+    /**
+     * @brief compute the non-redundant half of the spectrum.
+     * @param in @c size() real values
+     * @param out @c size()/2 + 1 spectrum bins X_k = Σ x_j exp(-2πi·jk/n)
+     */
+    void transform (const double* in, complex* out) const;
+    /// The same for @p nLanes interleaved sequences, see @c ComplexFFT
+    void transform (const double* in, complex* out, int nLanes) const;
+
+private:
+    template <typename lanes_t>
+    void _Transform (const double* in, complex* out, lanes_t nLanes) const;
+
+    int _N;
+    ComplexFFT _Packed;
+    /// exp(-2πi·k/n) for k <= n/2, used to unpack the half-length transform
+    std::vector <complex> _Twiddles;
+};
+
+#endif // FOURIER_H
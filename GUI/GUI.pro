@@ -5,9 +5,7 @@
 #-------------------------------------------------
 
 QT       += core gui
-#CONFIG   += c++14
-QMAKE_CXXFLAGS += -std=c++1y
-DEFINES  += _USE_MATH_DEFINES
+include(Core.pri)
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
 
@@ -17,7 +15,6 @@ TEMPLATE = app
 
 SOURCES += main.cc\
         MainWindow.cc \
-    TimeSeries.cc \
     AnalyzeWidget.cc \
     GenerateWidget.cc \
     CoefftWidget.cc \
@@ -26,7 +23,6 @@ SOURCES += main.cc\
     qcustomplot.cpp
 
 HEADERS  += MainWindow.h \
-    TimeSeries.h \
     AnalyzeWidget.h \
     GenerateWidget.h \
     CoefftWidget.h \
@@ -4,19 +4,22 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QFile>
+#include <QFileDialog>
+#include <QMessageBox>
 #include <QTextStream>
 
 #include <assert.h>
 #include <cmath>
 #include <functional>
 #include <iostream>
-#include <random>
 
 #include "helpers.h"
 #include "CoefftWidget.h"
+#include "Generator.h"
+#include "SeriesFile.h"
+#include "TimeSeries.h"
 
 using std::cerr;
-constexpr float M_2PI = M_PI * 2, M_2_E = 2 / M_E;
 
 QString spaceNumber (int n) {
     QString ans = QString::number(n);
@@ -25,58 +28,42 @@ QString spaceNumber (int n) {
     return ans;
 }
 
-float get_error (double mean, double disperse) {
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    static std::normal_distribution<> d (mean, disperse);
-
-    return d (gen);
-}
-
 /**
- * @brief Generate a time series and store it to a file
- * @param generator a function to sample data from.
- *        Should take float parameters in range 0.f..1.f
- * @param npoints how many points to sample
- * @param fname file to store data to
+ * @brief Convert the text series of a set to .tsb files
+ *
+ * The generator coefficients are taken from the .coeffts files
+ * next to the series, if there are any.
+ * @param from the directory with the text series
+ * @param to the directory to write the .tsb files to
+ * @return how many series have been converted
  */
-void generate_series (std::function <float (float, unsigned)> generator,
-                      unsigned npoints,
-                      const QString& fname) {
-    assert (npoints > 1);
-
-    const float step = 1.f / (npoints - 1);
-
-    QFile file (fname);
-    file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate);
-    QTextStream out(&file);
-    for (float arg = 0.f; npoints-->0; arg += step)
-        out << generator (arg, npoints) << "\n";
-}
-
-double stochastic (unsigned m, double r) {
-    static double last_r = -1;
-    static QMap <unsigned, double> cache;
-    if (r != last_r) {
-        cache.clear();
-        cache.insert(0u, 1.);
+int convert_set (const QDir& from, const QDir& to) {
+    to.mkdir(to.absolutePath());
+    int nConverted = 0;
+    for (const QString& fname : from.entryList(QDir::Readable | QDir::Files)) {
+        const QString path = from.absoluteFilePath(fname);
+        if (fname.toLower().endsWith(".coeffts") or SeriesFile::isSeriesFile(path))
+            continue;
+        TimeSeries ts;
+        ts.readFile(path);
+        if (ts.size() < 2)
+            // not a time series
+            continue;
+
+        QVector <double> k;
+        QFile coefficients (path + ".coeffts");
+        if (coefficients.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QTextStream in (&coefficients);
+            double v;
+            for (in >> v; in.status() == QTextStream::Ok; in >> v)
+                k.append(v);
+        }
+        if (SeriesFile::write(to.absoluteFilePath(fname + ".tsb"), ts.values(), k))
+            ++nConverted;
+        if (nConverted % 10 == 0)
+            QApplication::processEvents();
     }
-
-    if (cache.contains(m))
-        return cache [m];
-
-    auto fm = stochastic (m - 1, r);
-    auto ans = 4 * r * fm * (1 - fm);
-    cache.insert(m, ans);
-    return ans;
-}
-
-double series_generator (const QVector <double>& k, double x, unsigned index) {
-    return k[0] * sin (k[1] * M_2PI * x)
-         + k[2] * x
-         + k[3] * exp (k[4] * M_2_E * x)
-         + k[5] * log (k[6] * M_E * (x + 1))
-         + k[7] * stochastic(k[8] + index, k[9]);
+    return nConverted;
 }
 
 GenerateWidget::GenerateWidget(QWidget *parent) :
@@ -130,9 +117,13 @@ GenerateWidget::~GenerateWidget() {
     delete ui;
 }
 
-void GenerateWidget::forAllCoefficients (std::function<void (const QVector<double>&)>&& f) {
-    QVector <double> k (kWidgets.size());
-    iterateK(k, f, 0);
+QVector <generator::range_t> GenerateWidget::coefficientRanges() {
+    QVector <generator::range_t> ranges;
+    for (CoefftWidget* w : kWidgets) {
+        const auto info = w->getInfo();
+        ranges.append(generator::range_t {info.min, info.max, info.step});
+    }
+    return ranges;
 }
 
 void GenerateWidget::generate() {
@@ -154,39 +145,45 @@ void GenerateWidget::generate() {
     QApplication::processEvents();
     const double errmean = ui->errMean->value(),
                  errdisp = ui->errDisperse->value();
+    const bool binary = ui->binaryFormat->isChecked();
 
     setPath.mkdir(setPath.absolutePath());
 
     setSize = 0;
-    forAllCoefficients([this, errmean, errdisp, setPath, &id, npoints](const QVector <double>& k){
+    generator::forAllCoefficients(coefficientRanges(), [this, errmean, errdisp, binary, setPath, &id, npoints](const QVector <double>& k){
 //                if (setSize > 3000) {
 //                    std::cerr << "aborting generation, setSize exceeds 3000\n";
 //                    return;
 //                }
                 const QString fname =
                         setPath.absoluteFilePath("ts_" + QString::number(id++));
-                generate_series(
+                generator::generate_series(
                    [k, errmean, errdisp, npoints](float step, unsigned index){
-                       return series_generator(k, step, index)
-                            + get_error(errmean, errdisp);
+                       return generator::series_generator(k, step, index)
+                            + generator::get_error(errmean, errdisp);
                    },
                    npoints,
-                   fname
+                   fname,
+                   binary,
+                   k
                 );
 
-               QFile file (fname + ".coeffts");
-               file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate);
-               QTextStream out (&file);
-               for (double v : k)
-                   out << v << '\n';
+               if (not binary) {
+                   // .tsb files keep the coefficients in the header
+                   QFile file (fname + ".coeffts");
+                   file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate);
+                   QTextStream out (&file);
+                   for (double v : k)
+                       out << v << '\n';
+               }
 
                ui->progressBar->setValue(id);
                ++setSize;
                if (setSize % 10 == 0)
                    QApplication::processEvents();
     });
-    generate_series([](float, unsigned){return get_error(0., .8);}, npoints,
-                    setPath.absoluteFilePath( "ts_const"));
+    generator::generate_series([](float, unsigned){return generator::get_error(0., .8);}, npoints,
+                    setPath.absoluteFilePath( "ts_const"), binary);
 
     ui->labelReady->show();
     ui->labelSetSize->show();
@@ -198,23 +195,19 @@ void GenerateWidget::generate() {
 }
 
 void GenerateWidget::countSetSize() {
-    setSize = 1;
-    ui->countSetSize->setEnabled(false);
-    for (int i = 0; i < kWidgets.size(); ++i) {
-        auto range = kWidgets[i]->getInfo();
-        unsigned s = (range.max - range.min) / range.step;
-        s += static_cast <bool> (range.min + range.step * s < range.max);
-        setSize *= s;
-        QApplication::processEvents();
-    }
+    setSize = generator::setSize(coefficientRanges());
     ui->labelCount->setText(spaceNumber(setSize));
     ui->labelCount->show();
     ui->labelSetSize->show();
     auto label = plural("ряд", "", "а", "ов", setSize);
     QString sizeLabel;
 
-    // 13.5 kB per 1500 values in ont time series
-    auto kb = setSize * 13.5 / 1500. * ui->nValues->value();
+    // 13.5 kB per 1500 values in ont time series,
+    // 4 bytes per value plus the header and the coefficients in a .tsb file
+    const double seriesKb = ui->binaryFormat->isChecked()
+            ? (4. * ui->nValues->value() + 2 * SeriesFile::alignment) / 1024
+            : 13.5 / 1500. * ui->nValues->value();
+    auto kb = setSize * seriesKb;
     auto mb = kb / 1024;
     auto gb = mb / 1024;
     if (gb > 1)
@@ -228,28 +221,38 @@ void GenerateWidget::countSetSize() {
     ui->countSetSize->setEnabled(true);
 }
 
-template <class T>
-std::ostream& operator<< (std::ostream& str, const QVector<T>& data) {
-    for (auto _ : data)
-        str << _ << " ";
-    return str;
+void GenerateWidget::on_browseSetPath_clicked() {
+///@todo
 }
 
-void GenerateWidget::iterateK (QVector <double>& k,
-                               std::function <void (const QVector <double>&)>& f,
-                               unsigned index) {
-//    std::cerr << "Iterating with k = " << k << "... ";
-    if (index >= static_cast <unsigned> (k.size())) {
-//        std::cerr << "recursion end\n";
-        f (k);
+void GenerateWidget::on_convertSet_clicked() {
+    const QString from = QFileDialog::getExistingDirectory(this,
+                                 tr("Папка с текстовой выборкой рядов"),
+                                 ui->setPath->text());
+    if (from.isNull())
+        return;
+    const QString to = QFileDialog::getExistingDirectory(this,
+                                 tr("Куда записать выборку в формате .tsb"),
+                                 from);
+    if (to.isNull())
+        return;
+    if (QDir (from) == QDir (to)) {
+        QMessageBox::warning(this, tr("Преобразование выборки"),
+                             tr("Выберите другую папку: иначе каждый ряд "
+                                "окажется в выборке дважды."));
         return;
     }
 
-    auto range = kWidgets [index]->getInfo();
-    for (k [index] = range.min; k [index] <= range.max; k [index] += range.step)
-        iterateK(k, f, index + 1);
-}
+    ui->convertSet->setEnabled(false);
+    scope_exit ([this]{
+        ui->convertSet->setEnabled(true);
+    });
+    const int nConverted = convert_set (QDir (from), QDir (to));
 
-void GenerateWidget::on_browseSetPath_clicked() {
-///@todo
+    ui->labelReady->show();
+    ui->labelSetSize->show();
+    ui->labelCount->setText(spaceNumber(nConverted));
+    ui->labelCount->show();
+    ui->labelSeries->setText(plural("ряд", "", "а", "ов", nConverted));
+    ui->labelSeries->show();
 }
@@ -2,7 +2,8 @@
 #define GENERATEWIDGET_H
 
 #include <QWidget>
-#include <functional>
+
+#include "Generator.h"
 
 namespace Ui {
 class GenerateWidget;
@@ -23,23 +24,11 @@ private slots:
     void countSetSize ();
 
     void on_browseSetPath_clicked();
+    void on_convertSet_clicked();
 
 private:
-    /**
-     * @brief Call a function @f for all combinations of coefficients
-     */
-    void forAllCoefficients (std::function <void (const QVector <double>&)>&& f);
-    /**
-     * @brief iterate over the coefficients
-     * @param k current values of all the coefficients
-     * @param f function to call for each coefficients combination
-     * @param iterateBy index of the coefficient being changed by this recursion level.
-     *  if it is k.size() then f is actually called by this function,
-     *  otherwise this function is recursively called for iterateBy = iterateBy + 1.
-     */
-    void iterateK (QVector<double>& k,
-                   std::function<void (const QVector<double>&)>& f,
-                   unsigned iterateBy);
+    /// The ranges of the coefficients set by the user
+    QVector <generator::range_t> coefficientRanges ();
 
     Ui::GenerateWidget *ui;
     unsigned setSize;
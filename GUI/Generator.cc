@@ -0,0 +1,123 @@
+#include "Generator.h"
+#include "SeriesFile.h"
+
+#include <QFile>
+#include <QTextStream>
+
+#include <assert.h>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr float M_2PI = M_PI * 2, M_2_E = 2 / M_E;
+
+/// The m-th value of the logistic map with the parameter @p r, the values are kept for the same r
+double stochastic (unsigned m, double r) {
+    static double last_r = -1;
+    static std::vector <double> cache;
+    if (r != last_r) {
+        last_r = r;
+        cache.assign(1, 1.);
+    }
+
+    // the values are extended in a loop: a series of 10⁷ values would overflow the stack by recursion
+    while (cache.size() <= m) {
+        const double fm = cache.back();
+        cache.push_back(4 * r * fm * (1 - fm));
+    }
+    return cache [m];
+}
+
+/**
+ * @brief iterate over the coefficients
+ * @param k current values of all the coefficients
+ * @param f function to call for each coefficients combination
+ * @param iterateBy index of the coefficient being changed by this recursion level.
+ *  if it is k.size() then f is actually called by this function,
+ *  otherwise this function is recursively called for iterateBy = iterateBy + 1.
+ */
+void iterateK (const QVector <generator::range_t>& ranges,
+               QVector <double>& k,
+               const std::function <void (const QVector <double>&)>& f,
+               int iterateBy) {
+    if (iterateBy >= k.size()) {
+        f (k);
+        return;
+    }
+
+    const auto& range = ranges [iterateBy];
+    for (k [iterateBy] = range.min; k [iterateBy] <= range.max; k [iterateBy] += range.step)
+        iterateK(ranges, k, f, iterateBy + 1);
+}
+}
+
+namespace generator {
+const char* coefficientName(int index) {
+    static const char* names[nCoefficients] = {"a", "α", "b", "c", "γ", "d", "δ", "h", "m", "r"};
+    return 0 <= index and index < nCoefficients ? names[index] : "?";
+}
+
+double series_generator (const QVector <double>& k, double x, unsigned index) {
+    return k[0] * sin (k[1] * M_2PI * x)
+         + k[2] * x
+         + k[3] * exp (k[4] * M_2_E * x)
+         + k[5] * log (k[6] * M_E * (x + 1))
+         + k[7] * stochastic(k[8] + index, k[9]);
+}
+
+float get_error (double mean, double disperse) {
+    static std::random_device rd;
+    static std::mt19937 gen(rd());
+    static std::normal_distribution<> d (mean, disperse);
+
+    return d (gen);
+}
+
+bool generate_series (std::function <float (float, unsigned)> generator,
+                      unsigned npoints,
+                      const QString& fname,
+                      bool binary,
+                      const QVector <double>& coefficients) {
+    assert (npoints > 1);
+
+    const float step = 1.f / (npoints - 1);
+
+    if (binary) {
+        QVector <float> values (npoints);
+        float arg = 0.f;
+        for (float& v : values) {
+            v = generator (arg, --npoints);
+            arg += step;
+        }
+        return SeriesFile::write(fname + ".tsb",
+                                 Span <const float> (values.constData(), values.size()),
+                                 coefficients);
+    }
+
+    QFile file (fname);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        return false;
+    QTextStream out(&file);
+    for (float arg = 0.f; npoints-->0; arg += step)
+        out << generator (arg, npoints) << "\n";
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
+
+unsigned setSize (const QVector <range_t>& ranges) {
+    unsigned size = 1;
+    for (const range_t& range : ranges) {
+        unsigned s = (range.max - range.min) / range.step;
+        s += static_cast <bool> (range.min + range.step * s < range.max);
+        size *= s;
+    }
+    return size;
+}
+
+void forAllCoefficients (const QVector <range_t>& ranges,
+                         const std::function <void (const QVector <double>&)>& f) {
+    QVector <double> k (ranges.size());
+    iterateK(ranges, k, f, 0);
+}
+}
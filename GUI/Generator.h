@@ -0,0 +1,56 @@
+#ifndef GENERATOR_H_c1e7a934_58d2_4b6f_9e03_7fa2d61b8c45
+#define GENERATOR_H_c1e7a934_58d2_4b6f_9e03_7fa2d61b8c45
+
+#include <functional>
+
+#include <QString>
+#include <QVector>
+
+/**
+ * The synthetic series of the sets: each value is
+ *   a·sin (2πα·x) + b·x + c·exp (2γ/e·x) + d·ln (δe·(x + 1)) + h·f_{m + index}(r),
+ * where x goes from 0 to 1, index counts the values left and f is the logistic map
+ * f_0 = 1, f_{i+1} = 4r·f_i·(1 - f_i). The coefficients are in this order: a, α, b, c, γ, d, δ, h, m, r.
+ */
+namespace generator {
+constexpr int nCoefficients = 10;
+
+/// The range a coefficient goes through in a set, both ends included
+struct range_t {
+    double min, max, step;
+};
+
+/// The letter of the coefficient @p index in the formula
+const char* coefficientName (int index);
+
+/// The generated value at @p x with @p index values left after it, with no error
+double series_generator (const QVector <double>& k, double x, unsigned index);
+
+/// A sample of N (mean, disperse)
+float get_error (double mean, double disperse);
+
+/**
+ * @brief Generate a time series and store it to a file
+ * @param generator a function to sample data from.
+ *        Should take float parameters in range 0.f..1.f
+ * @param npoints how many points to sample
+ * @param fname file to store data to, ".tsb" is appended for the binary format
+ * @param binary whether to write a .tsb file (see @c SeriesFile) instead of text
+ * @param coefficients generator coefficients to store in the .tsb file
+ * @return false if the file could not be written
+ */
+bool generate_series (std::function <float (float, unsigned)> generator,
+                      unsigned npoints,
+                      const QString& fname,
+                      bool binary = false,
+                      const QVector <double>& coefficients = QVector <double> ());
+
+/// How many series a set with the coefficients in the @p ranges has
+unsigned setSize (const QVector <range_t>& ranges);
+
+/// Call @p f for all combinations of the coefficients in the @p ranges
+void forAllCoefficients (const QVector <range_t>& ranges,
+                         const std::function <void (const QVector <double>&)>& f);
+}
+
+#endif // GENERATOR_H
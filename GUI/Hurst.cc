@@ -0,0 +1,202 @@
+#include "Hurst.h"
+
+#include <cmath>
+#include <limits>
+
+namespace {
+/// The smallest window for the R/S and DFA estimators
+constexpr int minWindow = 8;
+
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+
+/// Slope of the least squares line through the points (x, y); NaN for less than 2 points
+double slope (const QVector <double>& x, const QVector <double>& y) {
+    const int n = x.size();
+    if (n < 2)
+        return NaN;
+    double mx = 0., my = 0.;
+    for (int i = 0; i < n; ++i) {
+        mx += x[i];
+        my += y[i];
+    }
+    mx /= n;
+    my /= n;
+    double sxy = 0., sxx = 0.;
+    for (int i = 0; i < n; ++i) {
+        sxy += (x[i] - mx) * (y[i] - my);
+        sxx += (x[i] - mx) * (x[i] - mx);
+    }
+    return sxy / sxx;
+}
+}
+
+HurstEngine::HurstEngine(const float* values, int n)
+    : _N (n), _Sum (n + 1), _SumSq (n + 1) {
+    double mean = 0.;
+    for (int i = 0; i < n; ++i)
+        mean += values[i];
+    mean = n > 0 ? mean / n : 0.;
+    _Offset = mean;
+
+    // centering keeps the variances from cancelling out
+    _Sum[0] = _SumSq[0] = 0.;
+    for (int i = 0; i < n; ++i) {
+        const double x = values[i] - mean;
+        _Sum[i + 1] = _Sum[i] + x;
+        _SumSq[i + 1] = _SumSq[i] + x * x;
+    }
+}
+
+double HurstEngine::_Variance(int begin, int end) const {
+    const double m = _Mean(begin, end),
+                 ans = (_SumSq[end] - _SumSq[begin]) / (end - begin) - m * m;
+    return ans > 0. ? ans : 0.;
+}
+
+double HurstEngine::estimate(HurstEstimator method, int begin, int end) const {
+    switch (method) {
+    case HurstEstimator::wholeSeries:   return wholeSeries(begin, end);
+    case HurstEstimator::rescaledRange: return rescaledRange(begin, end);
+    case HurstEstimator::dfa1:          return dfa(1, begin, end);
+    case HurstEstimator::dfa2:          return dfa(2, begin, end);
+    case HurstEstimator::haar:          return haar(begin, end);
+    }
+    return NaN;
+}
+
+const char* HurstEngine::name(HurstEstimator method) {
+    switch (method) {
+    case HurstEstimator::wholeSeries:   return "R/S по всему ряду";
+    case HurstEstimator::rescaledRange: return "R/S по окнам";
+    case HurstEstimator::dfa1:          return "DFA-1";
+    case HurstEstimator::dfa2:          return "DFA-2";
+    case HurstEstimator::haar:          return "Вейвлет Хаара";
+    }
+    return "???";
+}
+
+const char* HurstEngine::id(HurstEstimator method) {
+    switch (method) {
+    case HurstEstimator::wholeSeries:   return "whole";
+    case HurstEstimator::rescaledRange: return "rs";
+    case HurstEstimator::dfa1:          return "dfa1";
+    case HurstEstimator::dfa2:          return "dfa2";
+    case HurstEstimator::haar:          return "haar";
+    }
+    return "???";
+}
+
+QVector <HurstEstimator> HurstEngine::estimators() {
+    return QVector <HurstEstimator> {HurstEstimator::wholeSeries, HurstEstimator::rescaledRange,
+                                     HurstEstimator::dfa1, HurstEstimator::dfa2, HurstEstimator::haar};
+}
+
+double HurstEngine::wholeSeries(int begin, int end) const {
+    const int n = end - begin;
+    if (n < 2)
+        return NaN;
+    // the prefix sums less the mean are the cumulative deviations
+    const double m = _Mean(begin, end);
+    double Wmax = _Sum[begin + 1] - _Sum[begin] - m,
+           Wmin = Wmax;
+    for (int i = 2; i <= n; ++i) {
+        const double W = _Sum[begin + i] - _Sum[begin] - i * m;
+        Wmax = W > Wmax ? W : Wmax;
+        Wmin = W < Wmin ? W : Wmin;
+    }
+    return log ((Wmax - Wmin) / sqrt (_Variance(begin, end))) / log (n);
+}
+
+double HurstEngine::rescaledRange(int begin, int end) const {
+    const int n = end - begin;
+    QVector <double> logW, logRS;
+    for (int w = minWindow; w <= n / 2; w *= 2) {
+        double total = 0.;
+        int count = 0;
+        for (int a = begin; a + w <= end; a += w) {
+            const double S = sqrt (_Variance(a, a + w));
+            if (S == 0.)
+                continue;
+            const double m = _Mean(a, a + w);
+            double hi = _Sum[a + 1] - _Sum[a] - m,
+                   lo = hi;
+            for (int j = 2; j <= w; ++j) {
+                const double W = _Sum[a + j] - _Sum[a] - j * m;
+                hi = W > hi ? W : hi;
+                lo = W < lo ? W : lo;
+            }
+            total += (hi - lo) / S;
+            ++count;
+        }
+        if (count == 0 or total == 0.)
+            continue;
+        logW.append(log (w));
+        logRS.append(log (total / count));
+    }
+    return slope (logW, logRS);
+}
+
+double HurstEngine::dfa(int order, int begin, int end) const {
+    // _Sum[t + 1] is the profile at t
+    const int n = end - begin;
+    QVector <double> logW, logF;
+    for (int w = minWindow; w <= n / 4; w *= 2) {
+        // Local trends are fitted by projecting onto polynomials orthogonal over the window:
+        // 1, u and u² - Σu²/w, where u is the position relative to the window centre.
+        double su2 = 0., su4 = 0.;
+        for (int j = 0; j < w; ++j) {
+            const double u = j - (w - 1) / 2.;
+            su2 += u * u;
+            su4 += u * u * u * u;
+        }
+        const double c2 = su2 / w,
+                     sp2 = su4 - su2 * su2 / w;
+
+        double F2 = 0.;
+        int count = 0;
+        for (int a = begin; a + w <= end; a += w) {
+            // the profile is shifted by its first value in the window to keep the sums small
+            const double y0 = _Sum[a + 1];
+            double sY = 0., sUY = 0., sP2Y = 0., sYY = 0.;
+            for (int j = 0; j < w; ++j) {
+                const double y = _Sum[a + j + 1] - y0,
+                             u = j - (w - 1) / 2.;
+                sY += y;
+                sUY += u * y;
+                sP2Y += (u * u - c2) * y;
+                sYY += y * y;
+            }
+            double rss = sYY - sY * sY / w - sUY * sUY / su2;
+            if (order == 2)
+                rss -= sP2Y * sP2Y / sp2;
+            F2 += (rss > 0. ? rss : 0.) / w;
+            ++count;
+        }
+        if (F2 == 0.)
+            continue;
+        logW.append(log (w));
+        logF.append(log (F2 / count) / 2);
+    }
+    return slope (logW, logF);
+}
+
+double HurstEngine::haar(int begin, int end) const {
+    // E d² ~ w^(2H - 1) for the coefficients d normed by sqrt (w)
+    const int n = end - begin;
+    QVector <double> logW, logD;
+    for (int w = 2; w <= n / 2; w *= 2) {
+        const int half = w / 2;
+        double D = 0.;
+        int count = 0;
+        for (int a = begin; a + w <= end; a += w) {
+            const double d = (_Sum[a + w] - 2 * _Sum[a + half] + _Sum[a]);
+            D += d * d / w;
+            ++count;
+        }
+        if (D == 0.)
+            continue;
+        logW.append(log (w));
+        logD.append(log (D / count));
+    }
+    return (slope (logW, logD) + 1) / 2;
+}
@@ -0,0 +1,89 @@
+#ifndef HURST_H_cef98fb5_d0f9_4443_b5cc_c2ca420d7d94
+#define HURST_H_cef98fb5_d0f9_4443_b5cc_c2ca420d7d94
+
+#include <QVector>
+
+/// Methods to estimate the Hurst exponent of a series
+enum class HurstEstimator {
+    /// log (R/S) / log (n) over the whole series, the original coordinate
+    wholeSeries,
+    /// regression of the mean R/S over windows of the dyadic sizes
+    rescaledRange,
+    /// detrended fluctuation analysis with linear local trends
+    dfa1,
+    /// detrended fluctuation analysis with quadratic local trends
+    dfa2,
+    /// regression of the Haar wavelet coefficients variance over the dyadic scales
+    haar
+};
+
+/**
+ * @brief The Hurst exponent estimators sharing one pass of prefix sums.
+ *
+ * The values are centered by their mean and summed up once, then
+ * the mean and the variance of any window take O(1),
+ * and the prefix sums are the DFA profile at the same time.
+ * Each estimator looks at O(log n) window sizes with O(n) work per size.
+ * Any estimator may be applied to a part of the series as well,
+ * the prefix sums are shared by all the parts.
+ *
+ * Estimators other than @c wholeSeries return NaN
+ * if the series is too short for at least two window sizes.
+ */
+class HurstEngine {
+public:
+    HurstEngine (const float* values, int n);
+
+    int size () const noexcept { return _N; }
+
+    double estimate (HurstEstimator method) const {
+        return estimate (method, 0, _N);
+    }
+    /// Estimate the exponent of the values in [begin; end) only, e.g. of a sliding window
+    double estimate (HurstEstimator method, int begin, int end) const;
+
+    double wholeSeries () const { return wholeSeries (0, _N); }
+    double rescaledRange () const { return rescaledRange (0, _N); }
+    /// @param order 1 or 2, the degree of the local trends
+    double dfa (int order) const { return dfa (order, 0, _N); }
+    double haar () const { return haar (0, _N); }
+
+    double wholeSeries (int begin, int end) const;
+    double rescaledRange (int begin, int end) const;
+    double dfa (int order, int begin, int end) const;
+    double haar (int begin, int end) const;
+
+    /// Mean of the values in [begin; end)
+    double mean (int begin, int end) const {
+        return _Offset + _Mean (begin, end);
+    }
+    /// Population variance of the values in [begin; end)
+    double variance (int begin, int end) const {
+        return _Variance (begin, end);
+    }
+
+    /// User-readable estimator name (in Russian)
+    static const char* name (HurstEstimator method);
+    /// Machine-readable estimator name
+    static const char* id (HurstEstimator method);
+    /// All the estimators, the original one first
+    static QVector <HurstEstimator> estimators ();
+
+private:
+    /// Mean of the centered values in [begin; end)
+    double _Mean (int begin, int end) const {
+        return (_Sum[end] - _Sum[begin]) / (end - begin);
+    }
+    /// Population variance of the values in [begin; end)
+    double _Variance (int begin, int end) const;
+
+    int _N;
+    /// The mean of all the values, subtracted from them before summing up
+    double _Offset;
+    /// _Sum[i] is the sum of the first i centered values
+    QVector <double> _Sum;
+    /// _SumSq[i] is the sum of squares of the first i centered values
+    QVector <double> _SumSq;
+};
+
+#endif // HURST_H
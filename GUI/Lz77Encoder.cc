@@ -0,0 +1,159 @@
+#include "Lz77Encoder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace {
+constexpr int minMatch = 3;
+constexpr int maxMatch = 1 << 16;
+constexpr int hashBits = 16;
+
+/// How many bits are needed for @p v > 0
+int bitLength (unsigned v) {
+    int ans = 0;
+    for (; v; v >>= 1)
+        ++ans;
+    return ans;
+}
+
+/**
+ * @brief An adaptive model of the symbols 0..nSymbols - 1.
+ *
+ * All the symbols start with the same frequency, each coded symbol gets more weight,
+ * and the frequencies are halved now and then to follow the changes of the data.
+ */
+class model_t {
+public:
+    explicit model_t (int nSymbols)
+        : _Counts (nSymbols, 1), _Total (nSymbols) {}
+
+    /// How many bits the @p symbol takes, then count it
+    double code (int symbol) {
+        const double bits = log2 (_Total) - log2 (_Counts[symbol]);
+        _Counts[symbol] += increment;
+        _Total += increment;
+        if (_Total > limit) {
+            _Total = 0;
+            for (unsigned& c : _Counts)
+                _Total += c = (c + 1) / 2;
+        }
+        return bits;
+    }
+
+private:
+    static constexpr unsigned increment = 32, limit = 1 << 16;
+    std::vector <unsigned> _Counts;
+    unsigned _Total;
+};
+
+struct match_t {
+    int length = 0, distance = 0;
+};
+}
+
+qint64 Lz77Encoder::compressedSize(const void* data, qint64 size) {
+    if (size > INT32_MAX)
+        return -1;
+    const auto bytes = static_cast <const uint8_t*> (data);
+    const int n = size;
+
+    const int windowLog = 16 + _Level * 2 / 3;
+    const int window = 1 << windowLog,
+              mask = window - 1;
+    const int depth = (4 << (_Level / 2)) * (_Extreme ? 4 : 1);
+    _Head.assign(1 << hashBits, -1);
+    _Previous.resize(window);
+
+    auto hash = [bytes](int p) {
+        const uint32_t v = bytes[p] | bytes[p + 1] << 8 | bytes[p + 2] << 16;
+        return (v * 2654435761u) >> (32 - hashBits);
+    };
+    auto insert = [this, hash, n, mask](int p) {
+        if (p + minMatch > n)
+            return;
+        int& head = _Head[hash (p)];
+        _Previous[p & mask] = head;
+        head = p;
+    };
+    // the longest match for the position p among the ones inserted before it
+    auto find = [this, bytes, hash, n, window, mask, depth](int p) {
+        match_t best;
+        if (p + minMatch > n)
+            return best;
+        const int longest = std::min (n - p, maxMatch);
+        int candidate = _Head[hash (p)];
+        for (int left = depth; left > 0 and candidate >= 0 and candidate > p - window; --left) {
+            // a longer match must differ from the best one at its end
+            if (bytes[candidate + best.length] == bytes[p + best.length]) {
+                int length = 0;
+                while (length < longest and bytes[candidate + length] == bytes[p + length])
+                    ++length;
+                if (length > best.length) {
+                    best.length = length;
+                    best.distance = p - candidate;
+                    if (length == longest)
+                        break;
+                }
+            }
+            candidate = _Previous[candidate & mask];
+        }
+        if (best.length < minMatch)
+            best.length = 0;
+        return best;
+    };
+
+    model_t isMatch (2),
+            literals (256),
+            lengths (16 + bitLength (maxMatch) - 4),
+            distances (1 + windowLog + 1);
+    int lastDistance = 0;
+    double bits = 0.;
+
+    auto codeLiteral = [&](int p) {
+        bits += isMatch.code(0) + literals.code(bytes[p]);
+    };
+    auto codeMatch = [&](const match_t& m) {
+        bits += isMatch.code(1);
+        if (m.distance == lastDistance) {
+            bits += distances.code(0);
+        } else {
+            const int d = bitLength (m.distance);
+            bits += distances.code(d) + d - 1;
+            lastDistance = m.distance;
+        }
+        // short lengths have their own codes, the longer ones are coded by their bit lengths
+        const int l = m.length - minMatch;
+        if (l < 16) {
+            bits += lengths.code(l);
+        } else {
+            const int b = bitLength (l);
+            bits += lengths.code(16 + b - 5) + b - 1;
+        }
+    };
+
+    int i = 0;
+    match_t m = find (0);
+    while (i < n) {
+        insert (i);
+        if (m.length == 0) {
+            codeLiteral (i);
+            ++i;
+        } else {
+            // lazy evaluation: a longer match right after the literal is better
+            const match_t next = find (i + 1);
+            if (next.length > m.length) {
+                codeLiteral (i);
+                ++i;
+                m = next;
+                continue;
+            }
+            codeMatch (m);
+            for (int p = i + 1; p < i + m.length; ++p)
+                insert (p);
+            i += m.length;
+        }
+        m = find (i);
+    }
+    return static_cast <qint64> (ceil (bits / 8));
+}
@@ -0,0 +1,29 @@
+#ifndef LZ77ENCODER_H_e51a7c08_93d2_4f6b_8c4e_2b19f6a0d837
+#define LZ77ENCODER_H_e51a7c08_93d2_4f6b_8c4e_2b19f6a0d837
+
+#include <vector>
+
+#include "Compressor.h"
+
+/**
+ * @brief LZ77 parsing followed by adaptive entropy coding, in the spirit of zstd.
+ *
+ * The matches are found by hash chains over a window of up to 4 MiB with the lazy
+ * evaluation of one position. The literals, the match lengths, the distances
+ * (with a code for the repeated last one) and the literal/match flags are coded by
+ * adaptive frequency models; the size is the exact code length an arithmetic coder
+ * would approach, so nothing is actually written.
+ * The level sets the window and how far the chains are followed.
+ */
+class Lz77Encoder : public Compressor {
+public:
+    qint64 compressedSize (const void* data, qint64 size) override;
+
+private:
+    /// Where the last position with each hash of 3 bytes is, -1 if none
+    std::vector <int> _Head;
+    /// The previous position with the same hash for each position in the window
+    std::vector <int> _Previous;
+};
+
+#endif // LZ77ENCODER_H
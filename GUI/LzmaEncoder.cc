@@ -0,0 +1,47 @@
+#include "LzmaEncoder.h"
+
+#include <algorithm>
+
+#include <lzma.h>
+
+struct LzmaEncoder::stream_t {
+    lzma_stream stream = LZMA_STREAM_INIT;
+    /// The compressed data are written here and dropped
+    uint8_t output[1 << 16];
+
+    ~stream_t () {
+        lzma_end (&stream);
+    }
+};
+
+LzmaEncoder::LzmaEncoder()
+    : _Stream (new stream_t) {
+}
+
+LzmaEncoder::~LzmaEncoder() = default;
+
+qint64 LzmaEncoder::compressedSize(const void* data, qint64 size) {
+    lzma_options_lzma options;
+    if (lzma_lzma_preset(&options, _Level | (_Extreme ? LZMA_PRESET_EXTREME : 0)))
+        return -1;
+    // Powers of two keep the match finder the same size for similar inputs,
+    // so liblzma reuses its memory on the next initialization
+    uint32_t dictionary = LZMA_DICT_SIZE_MIN;
+    while (dictionary < options.dict_size and dictionary < size)
+        dictionary *= 2;
+    options.dict_size = std::min (dictionary, options.dict_size);
+
+    lzma_stream& stream = _Stream->stream;
+    if (lzma_alone_encoder(&stream, &options) != LZMA_OK)
+        return -1;
+    stream.next_in = static_cast <const uint8_t*> (data);
+    stream.avail_in = size;
+
+    lzma_ret ret;
+    do {
+        stream.next_out = _Stream->output;
+        stream.avail_out = sizeof (_Stream->output);
+        ret = lzma_code(&stream, LZMA_FINISH);
+    } while (ret == LZMA_OK);
+    return ret == LZMA_STREAM_END ? static_cast <qint64> (stream.total_out) : -1;
+}
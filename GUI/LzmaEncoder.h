@@ -0,0 +1,28 @@
+#ifndef LZMAENCODER_H_3c9e1f27_84d5_4b0a_9f63_e28a57d1b40c
+#define LZMAENCODER_H_3c9e1f27_84d5_4b0a_9f63_e28a57d1b40c
+
+#include "Compressor.h"
+
+/**
+ * @brief The LZMA encoder of liblzma working in memory.
+ *
+ * The data are encoded into the .lzma format, the same the lzma utility writes,
+ * but the output goes through a small buffer and only its length is kept.
+ * The level is the preset of xz, the extreme flag is its -e.
+ * The dictionary is not made larger than the data, which does not change the result.
+ * The encoder state and the match finder are allocated once and reused
+ * by the next calls as long as the settings stay the same.
+ */
+class LzmaEncoder : public Compressor {
+public:
+    LzmaEncoder ();
+    ~LzmaEncoder ();
+
+    qint64 compressedSize (const void* data, qint64 size) override;
+
+private:
+    struct stream_t;
+    std::unique_ptr <stream_t> _Stream;
+};
+
+#endif // LZMAENCODER_H
@@ -0,0 +1,192 @@
+#include "Manifest.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+
+namespace {
+const QString magic = "tsanalyzer-manifest";
+
+const char* statusName (Manifest::Status status) {
+    return status == Manifest::Status::done ? "done" : "failed";
+}
+
+/// Whether the last byte of the file is a new line, i.e. no line has been cut short
+bool endsWithNewLine (QFile& file) {
+    const qint64 size = file.size();
+    char last = 0;
+    const bool ok = size > 0 and file.seek(size - 1) and file.getChar(&last) and last == '\n';
+    file.seek(0);
+    return ok;
+}
+}
+
+/// Writes the lines of the entries, each of their parameters once
+class Manifest::_Writer {
+public:
+    _Writer (QTextStream& out, QHash <QString, int>& parameterIds)
+        : _Out (out), _ParameterIds (parameterIds) {}
+
+    void write (const QString& name, const entry_t& e) {
+        auto id = _ParameterIds.constFind(e.parameters);
+        if (id == _ParameterIds.constEnd()) {
+            id = _ParameterIds.insert(e.parameters, _ParameterIds.size());
+            _Out << "parameters\t" << *id << '\t' << e.parameters << '\n';
+        }
+        QString metrics (static_cast <int> (coordinates_t::nValues), '0');
+        for (size_t j = 0; j < coordinates_t::nValues; ++j)
+            if (e.metrics[j])
+                metrics[static_cast <int> (j)] = '1';
+        _Out << "series\t" << statusName (e.status) << '\t' << e.size << '\t' << e.modified << '\t'
+             << e.hash << '\t' << *id << '\t' << metrics << '\t' << name << '\n';
+    }
+
+private:
+    QTextStream& _Out;
+    QHash <QString, int>& _ParameterIds;
+};
+
+Manifest::Manifest(const QString& fileName)
+    : _FileName (fileName) {
+    QFile file (fileName);
+    if (not file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+    const bool complete = endsWithNewLine (file);
+    QTextStream in (&file);
+    in.setCodec("UTF-8");
+
+    QStringList fields = in.readLine().split('\t');
+    if (fields.size() != 2 or fields[0] != magic or fields[1].toInt() != currentVersion) {
+        qDebug () << "!!!" << fileName << "is no manifest of this version, the set is analysed anew";
+        return;
+    }
+    QHash <int, QString> parameters;
+    while (not in.atEnd()) {
+        const QString line = in.readLine();
+        if (in.atEnd() and not complete) {
+            qDebug () << "!!! the last line of" << fileName << "is cut short:" << line;
+            break;
+        }
+        fields = line.split('\t');
+        bool ok = true;
+        if (fields.size() == 3 and fields[0] == "parameters") {
+            const int id = fields[1].toInt(&ok);
+            parameters.insert(id, fields[2]);
+            _ParameterIds.insert(fields[2], id);
+        } else if (fields.size() == 8 and fields[0] == "series") {
+            entry_t e;
+            bool sizeOk, modifiedOk, parametersOk;
+            e.status = fields[1] == "failed" ? Status::failed : Status::done;
+            e.size = fields[2].toLongLong(&sizeOk);
+            e.modified = fields[3].toLongLong(&modifiedOk);
+            e.hash = fields[4].toLatin1();
+            const int p = fields[5].toInt(&parametersOk);
+            ok = sizeOk and modifiedOk and parametersOk and parameters.contains(p)
+             and fields[6].size() == static_cast <int> (coordinates_t::nValues);
+            if (ok) {
+                e.parameters = parameters.value(p);
+                for (size_t j = 0; j < coordinates_t::nValues; ++j)
+                    e.metrics[j] = fields[6][static_cast <int> (j)] == '1';
+                _Entries.insert(fields[7], e);
+                ++_NLines;
+            }
+        } else if (not line.isEmpty()) {
+            ok = false;
+        }
+        if (not ok)
+            qDebug () << "!!! wrong line in" << fileName << ":" << line;
+    }
+    // the appends go on only after the lines that are all right
+    if (complete and in.status() == QTextStream::Ok)
+        _FileSize = file.size();
+}
+
+const Manifest::entry_t* Manifest::find(const QString& name) const {
+    const auto i = _Entries.constFind(name);
+    return i == _Entries.constEnd() ? nullptr : &*i;
+}
+
+void Manifest::set(const QString& name, const entry_t& entry) {
+    _Entries.insert(name, entry);
+    _Changed.insert(name);
+    _Dirty = true;
+}
+
+QSet <QByteArray> Manifest::hashes() const {
+    QSet <QByteArray> ans;
+    for (auto i = _Entries.constBegin(); i != _Entries.constEnd(); ++i)
+        ans.insert(i->hash);
+    return ans;
+}
+
+bool Manifest::commit() {
+    if (not _Dirty)
+        return true;
+    // the file is rewritten once the old lines make a half of it, so a line is written twice on average
+    const bool append = _FileSize >= 0 and QFileInfo (_FileName).size() == _FileSize
+                    and _NLines + _Changed.size() <= 2 * _Entries.size();
+    if (not (append ? _Append () : _Compact ())) {
+        // whatever has got into the file, the next commit replaces it
+        _FileSize = -1;
+        return false;
+    }
+    _Changed.clear();
+    _Dirty = false;
+    return true;
+}
+
+bool Manifest::_Append() {
+    QFile file (_FileName);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+        return false;
+    QTextStream out (&file);
+    out.setCodec("UTF-8");
+    _Writer writer (out, _ParameterIds);
+    for (const QString& name : _Changed)
+        writer.write(name, _Entries[name]);
+    out.flush();
+    if (out.status() != QTextStream::Ok or not file.flush())
+        return false;
+    _NLines += _Changed.size();
+    _FileSize = file.size();
+    return true;
+}
+
+bool Manifest::_Compact() {
+    QSaveFile file (_FileName);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Text))
+        return false;
+    QTextStream out (&file);
+    out.setCodec("UTF-8");
+    out << magic << '\t' << currentVersion << '\n';
+
+    // the parameters are the same for most of the series, they are written once
+    _ParameterIds.clear();
+    _Writer writer (out, _ParameterIds);
+    for (auto i = _Entries.constBegin(); i != _Entries.constEnd(); ++i)
+        writer.write(i.key(), *i);
+    out.flush();
+    if (out.status() != QTextStream::Ok or not file.commit())
+        return false;
+    _NLines = _Entries.size();
+    _FileSize = QFileInfo (_FileName).size();
+    return true;
+}
+
+QString Manifest::path(const QDir& destDir) {
+    return destDir.absoluteFilePath(manifestName);
+}
+
+QByteArray Manifest::contentHash(const QString& fileName) {
+    QFile file (fileName);
+    if (not file.open(QIODevice::ReadOnly))
+        return QByteArray ();
+    QCryptographicHash hash (QCryptographicHash::Sha1);
+    if (not hash.addData(&file))
+        return QByteArray ();
+    return hash.result().toHex();
+}
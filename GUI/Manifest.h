@@ -0,0 +1,103 @@
+#ifndef MANIFEST_H_c81f4a36_2d9e_4b07_a5f3_6e19d08b7c42
+#define MANIFEST_H_c81f4a36_2d9e_4b07_a5f3_6e19d08b7c42
+
+#include <bitset>
+
+#include <QByteArray>
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include "Coordinates.h"
+
+/**
+ * @brief What has been done with each series of a set: the input seen and the outcome.
+ *
+ * A series is identified by its size and modification time, which cost nothing to check
+ * as the sizes are read for the work costs anyway, and, when these change, by its content
+ * hash, so touching a file does not make it analysed again.
+ * The analysis parameters are kept with each series, a series analysed with other ones is stale.
+ *
+ * The manifest is a text file in the processed directory:
+ *  - @c "tsanalyzer-manifest" and the version;
+ *  - @c "parameters", a number and the parameters the number stands for;
+ *  - @c "series", the status, the size, the modification time in ms since the epoch,
+ *    the SHA-1 of the content in hex, the number of the parameters, the metrics done
+ *    as a string of 0 and 1 by the coordinate number and the name last;
+ * the fields are separated by tabs. A @c commit appends the lines of the series changed since
+ * the previous one, a later line of a series replaces the earlier ones, so a commit costs
+ * as much as the changes are and not as the whole set is. Once the file has more old lines
+ * than current ones it is replaced as a whole, so it is either the old one or the new one
+ * after a crash; a line cut short by a crash while appending is ignored.
+ */
+class Manifest {
+public:
+    static constexpr int currentVersion = 1;
+    /// The name of the manifest in the processed directory of a set
+    static constexpr const char* manifestName = "manifest.tsv";
+
+    enum class Status {
+        /// The coordinates are in the store
+        done,
+        /// The file is not a time series or the compression failed
+        failed
+    };
+    struct entry_t {
+        Status status = Status::done;
+        qint64 size = -1;
+        qint64 modified = 0;
+        QByteArray hash;
+        QString parameters;
+        std::bitset <coordinates_t::nValues> metrics;
+
+        /// Whether the file is the same by the size and the modification time
+        bool sameStat (qint64 size_, qint64 modified_) const noexcept {
+            return size == size_ and modified == modified_;
+        }
+        /// Whether the @p metrics with the @p parameters have been done
+        bool covers (const QString& parameters_, const std::bitset <coordinates_t::nValues>& metrics_) const {
+            return parameters == parameters_ and (metrics_ & ~metrics).none();
+        }
+    };
+
+    /// Read the manifest; an absent or unreadable one is empty, so everything is redone
+    explicit Manifest (const QString& fileName);
+
+    int size () const { return _Entries.size(); }
+    /// The entry of the series @p name, nullptr if there is none; invalidated by @c set
+    const entry_t* find (const QString& name) const;
+    void set (const QString& name, const entry_t& entry);
+    /// The content hashes of all the series
+    QSet <QByteArray> hashes () const;
+    /// Whether there are changes not committed yet
+    bool isDirty () const noexcept { return _Dirty; }
+    /// Write the changes down, appending them or rewriting the file, false on errors
+    bool commit ();
+
+    /// The manifest of the set processed into the @p destDir
+    static QString path (const QDir& destDir);
+    /// The SHA-1 of the file in hex, empty if it can't be read
+    static QByteArray contentHash (const QString& fileName);
+
+private:
+    class _Writer;
+    /// Append the lines of the changed entries to the file as it is
+    bool _Append ();
+    /// Atomically replace the file with the lines of the current entries
+    bool _Compact ();
+
+    QString _FileName;
+    QHash <QString, entry_t> _Entries;
+    bool _Dirty = false;
+    /// The series set since the last commit
+    QSet <QString> _Changed;
+    /// The numbers of the parameters in the file
+    QHash <QString, int> _ParameterIds;
+    /// How many series lines the file has, the replaced ones included
+    int _NLines = 0;
+    /// The size of the file as it was read or written, -1 if it is to be replaced
+    qint64 _FileSize = -1;
+};
+
+#endif // MANIFEST_H
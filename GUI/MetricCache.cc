@@ -0,0 +1,174 @@
+#include "MetricCache.h"
+#include "Coordinates.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+
+namespace {
+const QString magic = "tsanalyzer-metrics";
+
+/// Whether the last byte of the file is a new line, i.e. no line has been cut short
+bool endsWithNewLine (QFile& file) {
+    const qint64 size = file.size();
+    char last = 0;
+    const bool ok = size > 0 and file.seek(size - 1) and file.getChar(&last) and last == '\n';
+    file.seek(0);
+    return ok;
+}
+}
+
+MetricCache::MetricCache(const QString& fileName)
+    : _FileName (fileName) {
+    QFile file (fileName);
+    if (not file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return;
+    const bool complete = endsWithNewLine (file);
+    QTextStream in (&file);
+    in.setCodec("UTF-8");
+
+    QStringList fields = in.readLine().split('\t');
+    if (fields.size() != 2 or fields[0] != magic or fields[1].toInt() != currentVersion) {
+        qDebug () << "!!!" << fileName << "is no metrics cache of this version, it is ignored";
+        return;
+    }
+    while (not in.atEnd()) {
+        const QString line = in.readLine();
+        if (in.atEnd() and not complete) {
+            qDebug () << "!!! the last line of" << fileName << "is cut short:" << line;
+            break;
+        }
+        fields = line.split('\t');
+        bool ok = fields.size() == 4;
+        const size_t coordinate = ok ? coordinates_t::coordinateIndex(fields[1]) : coordinates_t::nValues;
+        const double value = ok ? fields[3].toDouble(&ok) : 0.;
+        if (ok and coordinate < coordinates_t::nValues) {
+            _Values.insert(_Key (fields[0].toLatin1(), coordinate, fields[2]), value);
+            ++_NLines;
+        } else if (not line.isEmpty()) {
+            qDebug () << "!!! wrong line in" << fileName << ":" << line;
+        }
+    }
+    // the appends go on only after the lines that are all right
+    if (complete and in.status() == QTextStream::Ok)
+        _FileSize = file.size();
+}
+
+QString MetricCache::_Key(const QByteArray& hash, size_t coordinate, const QString& parameters) {
+    return QString::fromLatin1(hash) + '\t' + coordinates_t::coordinateId(coordinate) + '\t' + parameters;
+}
+
+bool MetricCache::find(const QByteArray& hash, size_t coordinate, const QString& parameters,
+                       double& value) const {
+    const QString key = _Key (hash, coordinate, parameters);
+    std::lock_guard <std::mutex> lock (_Mutex);
+    const auto i = _Values.constFind(key);
+    if (i == _Values.constEnd())
+        return false;
+    value = *i;
+    return true;
+}
+
+void MetricCache::insert(const QByteArray& hash, size_t coordinate, const QString& parameters,
+                         double value) {
+    const QString key = _Key (hash, coordinate, parameters);
+    std::lock_guard <std::mutex> lock (_Mutex);
+    _Values.insert(key, value);
+    _Changed.insert(key);
+    _Dirty = true;
+}
+
+int MetricCache::size() const {
+    std::lock_guard <std::mutex> lock (_Mutex);
+    return _Values.size();
+}
+
+int MetricCache::evict(const QSet <QByteArray>& hashes) {
+    std::lock_guard <std::mutex> lock (_Mutex);
+    QHash <QString, double> kept;
+    for (auto i = _Values.constBegin(); i != _Values.constEnd(); ++i)
+        if (hashes.contains(i.key().left(i.key().indexOf('\t')).toLatin1()))
+            kept.insert(i.key(), *i);
+    const int nEvicted = _Values.size() - kept.size();
+    if (nEvicted > 0) {
+        _Values = kept;
+        // the lines of the evicted values go with the next commit
+        _FileSize = -1;
+        _Dirty = true;
+    }
+    return nEvicted;
+}
+
+bool MetricCache::commit() {
+    // the values are copied so that the workers go on inserting while they are written
+    QHash <QString, double> values;
+    bool append;
+    int nLines;
+    {
+        std::lock_guard <std::mutex> lock (_Mutex);
+        if (not _Dirty)
+            return true;
+        // the file is rewritten once the old lines make a half of it, so a line is written twice on average
+        append = _FileSize >= 0 and QFileInfo (_FileName).size() == _FileSize
+             and _NLines + _Changed.size() <= 2 * _Values.size();
+        if (append) {
+            for (const QString& key : _Changed)
+                values.insert(key, _Values.value(key));
+        } else {
+            values = _Values;
+        }
+        nLines = append ? _NLines + _Changed.size() : _Values.size();
+        _Changed.clear();
+        _Dirty = false;
+    }
+
+    bool ok;
+    qint64 fileSize = -1;
+    if (append) {
+        QFile file (_FileName);
+        ok = file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+        if (ok) {
+            QTextStream out (&file);
+            out.setCodec("UTF-8");
+            // the values go back exactly as they were computed
+            out.setRealNumberPrecision(17);
+            for (auto i = values.constBegin(); i != values.constEnd(); ++i)
+                out << i.key() << '\t' << i.value() << '\n';
+            out.flush();
+            ok = out.status() == QTextStream::Ok and file.flush();
+            fileSize = file.size();
+        }
+    } else {
+        QSaveFile file (_FileName);
+        ok = file.open(QIODevice::WriteOnly | QIODevice::Text);
+        if (ok) {
+            QTextStream out (&file);
+            out.setCodec("UTF-8");
+            out.setRealNumberPrecision(17);
+            out << magic << '\t' << currentVersion << '\n';
+            for (auto i = values.constBegin(); i != values.constEnd(); ++i)
+                out << i.key() << '\t' << i.value() << '\n';
+            out.flush();
+            ok = out.status() == QTextStream::Ok and file.commit();
+            fileSize = QFileInfo (_FileName).size();
+        }
+    }
+
+    std::lock_guard <std::mutex> lock (_Mutex);
+    if (ok) {
+        _NLines = nLines;
+        _FileSize = fileSize;
+    } else {
+        // whatever has got into the file, the next commit replaces it with all the values
+        _FileSize = -1;
+        _Dirty = true;
+    }
+    return ok;
+}
+
+QString MetricCache::path(const QDir& destDir) {
+    return destDir.absoluteFilePath(cacheName);
+}
@@ -0,0 +1,65 @@
+#ifndef METRICCACHE_H_4a7d2e90_b318_4c65_8f0e_d15c93a6b728
+#define METRICCACHE_H_4a7d2e90_b318_4c65_8f0e_d15c93a6b728
+
+#include <mutex>
+
+#include <QByteArray>
+#include <QDir>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+/**
+ * @brief The values of the metrics ever computed for the series of a set, by the parameters.
+ *
+ * A value is keyed by the content hash of the series, the coordinate and the parameters
+ * the coordinate depends on, see @c AnalysisEngine::metricParameters: going back
+ * to the parameters of a previous run takes no computation, and changing one of them
+ * only recomputes the coordinates depending on it.
+ *
+ * The cache is a text file in the processed directory: @c "tsanalyzer-metrics" and the version,
+ * then a line per value: the content hash, the coordinate id, the parameters and the value,
+ * separated by tabs. A @c commit appends the values inserted since the previous one, the file
+ * is replaced as a whole only once its old lines would outnumber the values or some have been
+ * evicted, see @c evict; a line cut short by a crash while appending is ignored.
+ * The lookups and the inserts may come from any thread.
+ */
+class MetricCache {
+public:
+    static constexpr int currentVersion = 1;
+    /// The name of the cache in the processed directory of a set
+    static constexpr const char* cacheName = "metrics.tsv";
+
+    /// Read the cache; an absent or unreadable one is empty
+    explicit MetricCache (const QString& fileName);
+    MetricCache (const MetricCache&) = delete;
+    MetricCache& operator= (const MetricCache&) = delete;
+
+    /// Find the value of the @p coordinate of the series with the content @p hash, false if there is none
+    bool find (const QByteArray& hash, size_t coordinate, const QString& parameters, double& value) const;
+    void insert (const QByteArray& hash, size_t coordinate, const QString& parameters, double value);
+    int size () const;
+    /// Drop the values of the series with the content none of the @p hashes, return how many
+    int evict (const QSet <QByteArray>& hashes);
+    /// Write the changes down, appending them or rewriting the file, false on errors
+    bool commit ();
+
+    /// The cache of the set processed into the @p destDir
+    static QString path (const QDir& destDir);
+
+private:
+    static QString _Key (const QByteArray& hash, size_t coordinate, const QString& parameters);
+
+    QString _FileName;
+    mutable std::mutex _Mutex;
+    QHash <QString, double> _Values;
+    bool _Dirty = false;
+    /// The keys inserted since the last commit
+    QSet <QString> _Changed;
+    /// How many value lines the file has, the replaced and the evicted ones included
+    int _NLines = 0;
+    /// The size of the file as it was read or written, -1 if it is to be replaced
+    qint64 _FileSize = -1;
+};
+
+#endif // METRICCACHE_H
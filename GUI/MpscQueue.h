@@ -0,0 +1,66 @@
+#ifndef MPSCQUEUE_H_0b4e7d29_61c3_4a8f_b25d_e93f1a7c6054
+#define MPSCQUEUE_H_0b4e7d29_61c3_4a8f_b25d_e93f1a7c6054
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief An unbounded lock-free queue with many producers and a single consumer.
+ *
+ * The producers only exchange the head pointer and link the previous node to theirs,
+ * so a push never waits for the consumer nor for another producer.
+ * A pushed value may stay invisible to @c pop for the moment between the two steps
+ * of its producer; the consumer just sees it on its next call.
+ * The algorithm is the one of D. Vyukov's intrusive MPSC node-based queue.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    MpscQueue () : _Head (&_Stub), _Tail (&_Stub) {}
+    MpscQueue (const MpscQueue&) = delete;
+    MpscQueue& operator= (const MpscQueue&) = delete;
+    ~MpscQueue () {
+        T value;
+        while (pop (value))
+            ;
+        if (_Tail != &_Stub)
+            delete _Tail;
+    }
+
+    /// Add the value, may be called from any thread
+    void push (T value) {
+        _Node* node = new _Node (std::move (value));
+        _Node* previous = _Head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /// Take the oldest value visible, false if there is none; only the consumer thread may call it
+    bool pop (T& value) {
+        _Node* tail = _Tail;
+        _Node* next = tail->next.load(std::memory_order_acquire);
+        if (next == nullptr)
+            return false;
+        value = std::move (next->value);
+        // the node of the value taken becomes the new stub
+        _Tail = next;
+        if (tail != &_Stub)
+            delete tail;
+        return true;
+    }
+
+private:
+    struct _Node {
+        _Node () = default;
+        explicit _Node (T&& value) : value (std::move (value)) {}
+        std::atomic <_Node*> next {nullptr};
+        T value;
+    };
+
+    _Node _Stub;
+    /// The last node pushed
+    std::atomic <_Node*> _Head;
+    /// The node before the oldest one not popped yet
+    _Node* _Tail;
+};
+
+#endif // MPSCQUEUE_H
@@ -0,0 +1,174 @@
+#include "NumberParser.h"
+
+#include <QByteArray>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace {
+bool isSpace (char c) {
+    return c == ' ' or (c >= '\t' and c <= '\r');
+}
+
+bool isDigit (char c) {
+    return static_cast <unsigned char> (c - '0') < 10;
+}
+
+/// Does [p; end) spell the lowercase @p word in any case
+bool isWord (const char* p, const char* end, const char* word) {
+    const size_t length = strlen (word);
+    if (static_cast <size_t> (end - p) != length)
+        return false;
+    for (size_t i = 0; i < length; ++i)
+        if ((p[i] | 0x20) != word[i])
+            return false;
+    return true;
+}
+
+/// All the powers of 10 that are exact in double
+constexpr double powersOf10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+constexpr int maxExactPower = 22;
+constexpr uint64_t maxExactMantissa = uint64_t (1) << 53;
+/// More digits may overflow the 64-bit mantissa
+constexpr int maxDigits = 19;
+
+/// Narrow the parsed value as @c QString::toFloat does: overflows and underflows fail
+bool narrow (double d, float& value) {
+    if (std::isinf (d) or std::isnan (d)) {
+        value = static_cast <float> (d);
+        return true;
+    }
+    if (std::fabs (d) > std::numeric_limits <float>::max())
+        return false;
+    const float f = static_cast <float> (d);
+    if (d != 0. and f == 0.f)
+        return false;
+    value = f;
+    return true;
+}
+}
+
+bool parseFloat(const char* begin, const char* end, float& value) {
+    while (begin != end and isSpace (*begin))
+        ++begin;
+    while (end != begin and isSpace (end[-1]))
+        --end;
+    if (begin == end)
+        return false;
+
+    const char* p = begin;
+    const bool negative = *p == '-';
+    if (*p == '-' or *p == '+')
+        ++p;
+
+    if (isWord (p, end, "inf")) {
+        value = negative ? -std::numeric_limits <float>::infinity()
+                         : std::numeric_limits <float>::infinity();
+        return true;
+    }
+    if (p == begin and isWord (p, end, "nan")) {
+        value = std::numeric_limits <float>::quiet_NaN();
+        return true;
+    }
+
+    // The leading zeros are not counted as significant digits,
+    // the exponent is adjusted for the fractional digits.
+    uint64_t mantissa = 0;
+    int nDigits = 0, exponent = 0;
+    bool anyDigits = false, tooLong = false;
+    for (; p != end and isDigit (*p); ++p) {
+        anyDigits = true;
+        if (mantissa == 0 and *p == '0')
+            continue;
+        if (nDigits < maxDigits) {
+            mantissa = mantissa * 10 + (*p - '0');
+            ++nDigits;
+        } else {
+            tooLong = true;
+        }
+    }
+    if (p != end and *p == '.') {
+        for (++p; p != end and isDigit (*p); ++p) {
+            anyDigits = true;
+            if (mantissa == 0 and *p == '0') {
+                --exponent;
+                continue;
+            }
+            if (nDigits < maxDigits) {
+                mantissa = mantissa * 10 + (*p - '0');
+                ++nDigits;
+                --exponent;
+            } else {
+                tooLong = true;
+            }
+        }
+    }
+    if (not anyDigits)
+        return false;
+
+    if (p != end and (*p | 0x20) == 'e') {
+        ++p;
+        const bool negativeExponent = p != end and *p == '-';
+        if (p != end and (*p == '-' or *p == '+'))
+            ++p;
+        if (p == end or not isDigit (*p))
+            return false;
+        int e = 0;
+        for (; p != end and isDigit (*p); ++p)
+            // large enough to overflow anyway, small enough not to overflow int
+            if (e < 100000)
+                e = e * 10 + (*p - '0');
+        exponent += negativeExponent ? -e : e;
+    }
+    if (p != end)
+        return false;
+
+    double d;
+    if (mantissa == 0) {
+        d = 0.;
+    } else if (not tooLong and mantissa <= maxExactMantissa
+               and exponent >= -maxExactPower and exponent <= maxExactPower) {
+        // Both operands are exact, so IEEE arithmetics rounds the only operation correctly
+        d = exponent < 0 ? mantissa / powersOf10[-exponent]
+                         : mantissa * powersOf10[exponent];
+    } else {
+        // rare enough to afford a temporary buffer
+        bool ok;
+        d = QByteArray (begin, static_cast <int> (end - begin)).toDouble(&ok);
+        if (not ok)
+            return false;
+        return narrow (d, value);
+    }
+    return narrow (negative ? -d : d, value);
+}
+
+QVector <float> parseFloatLines(const char* data, qint64 size) {
+    const char* p = data;
+    const char* const end = data + size;
+    if (size >= 3 and memcmp (p, "\xEF\xBB\xBF", 3) == 0)
+        p += 3;
+
+    // one slot per line, cut down to the parsed values in the end
+    qint64 nLines = 1;
+    for (const char* q = p; (q = static_cast <const char*> (memchr (q, '\n', end - q))); ++q)
+        ++nLines;
+    QVector <float> values (static_cast <int> (nLines));
+    float* out = values.data();
+
+    int n = 0;
+    while (p != end) {
+        const char* eol = static_cast <const char*> (memchr (p, '\n', end - p));
+        if (not eol)
+            eol = end;
+        if (parseFloat (p, eol, out[n]))
+            ++n;
+        p = eol == end ? end : eol + 1;
+    }
+    values.resize(n);
+    return values;
+}
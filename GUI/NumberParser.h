@@ -0,0 +1,28 @@
+#ifndef NUMBERPARSER_H_3e6f1d2a_7c58_4b0e_9a41_5d2c8e9b0f67
+#define NUMBERPARSER_H_3e6f1d2a_7c58_4b0e_9a41_5d2c8e9b0f67
+
+#include <QVector>
+
+/**
+ * @brief parse a decimal number in [@p begin; @p end) the way @c QString::toFloat does.
+ *
+ * The parser is locale-independent: the decimal separator is always a dot.
+ * White space around the number is allowed, anything else fails the parse,
+ * as well as the values out of the float range. @c nan and @c inf are accepted.
+ *
+ * Up to 19 significant digits with a moderate exponent are converted exactly
+ * without any memory allocations; longer mantissas fall back to Qt.
+ *
+ * @return whether the text is a number; @p value is not changed otherwise
+ */
+bool parseFloat (const char* begin, const char* end, float& value);
+
+/**
+ * @brief parse newline-separated ASCII numbers, one per line.
+ *
+ * Both "\n" and "\r\n" line ends are understood, an UTF-8 byte order mark is skipped.
+ * The lines that are not numbers (see @c parseFloat) are skipped.
+ */
+QVector <float> parseFloatLines (const char* data, qint64 size);
+
+#endif // NUMBERPARSER_H
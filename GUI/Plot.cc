@@ -78,14 +78,19 @@ QList <Plot::colouredFiles> Plot::getAllFiles (const QDir& dir, int& nFiles) {
         return QColor::fromRgb(r, g, b);
     }();
 
-    QStringList lst = dir.entryList(QStringList() << "*.coords",
-                                    QDir::Readable | QDir::Files);
     QList <Plot::colouredFiles> ans;
-    nFiles = lst.size();
-    if (nFiles != 0)
-        ans.append(colouredFiles {lst, dir, colour});
+    nFiles = 0;
+    // the .coords files of the older versions are read as they are, the data shown is not written
+    const QString storePath = CoordinatesStore::path(dir);
+    const auto store = QFile::exists(storePath)
+                     ? std::make_shared <const CoordinatesStore> (storePath)
+                     : std::make_shared <const CoordinatesStore> (CoordinatesStore::readCoords(dir));
+    if (store->isValid() and store->nLiveRows() > 0) {
+        nFiles = store->nLiveRows();
+        ans.append(colouredFiles {store, colour});
+    }
 
-    lst = dir.entryList(QDir::Readable | QDir::Dirs | QDir::NoDotAndDotDot);
+    QStringList lst = dir.entryList(QDir::Readable | QDir::Dirs | QDir::NoDotAndDotDot);
     for (const auto& d : lst) {
         QDir nextDir (dir.filePath(d));
         if (excludedPaths.contains(nextDir.canonicalPath())) {
@@ -129,43 +134,14 @@ void Plot::refreshPlot() {
 
     double xmin = 0, xmax = 5, ymin = 0, ymax = 5;
 
-    auto read_file = [setDir, this](const QString& fname, double& x, double& y){
-        QFile file (fname);
-        file.open(QIODevice::ReadOnly);
-        if (file.size() < 2) {
-            // some invalid empty file
-            return false;
-        }
-        QTextStream coordinates (&file);
-        coordinates_t point;
-        for (size_t j = 0; j < coordinates_t::nValues; ++j) {
-            coordinates >> point.values[j];
-            if (coordinates.status() != coordinates.Ok) {
-                return false;
-            }
-        }
-        x = point.values[ui->axisX->currentIndex()];
-        y = point.values[ui->axisY->currentIndex()];
-        return std::isfinite(x) and std::isfinite(y);
-    };
-
-    double x1, y1;
-    for (auto& cset : lst)
-        for (const QString& fname : cset.fnames) {
-            // read the first file and set starting values for x and y ranges
-            if (not read_file (cset.dir.filePath(fname), x1, y1))
-                continue;
-            xmin = xmax = x1;
-            ymin = ymax = y1;
-            goto got_ranges;
-        }
-got_ranges:
+    const int axisX = ui->axisX->currentIndex(), axisY = ui->axisY->currentIndex();
 
+    bool got_ranges = false;
     int progress = 0;
     int graph_no = 0;
     for (const colouredFiles& files : lst) {
         const QColor colour = files.colour;
-        const QDir& dir = files.dir;
+        const CoordinatesStore& store = *files.store;
         ui->plotWidget->addGraph(ui->plotWidget->yAxis, ui->plotWidget->xAxis);
         auto graph = ui->plotWidget->graph(graph_no++);
         graph->setLineStyle(QCPGraph::lsNone);
@@ -174,24 +150,35 @@ got_ranges:
 
         QVector <double> x, y;
 
-        x.reserve(lst.size());
-        y.reserve(lst.size());
-
-        for (const auto& fname : files.fnames) {
-            ui->progressBar->setValue(progress++);
-            if (progress % 20 == 0)
-                QApplication::processEvents();
-            if (not read_file (dir.filePath(fname), x1, y1))
-                continue;
-            if (std::isnan(x1) or std::isnan(y1) or std::isinf(x1) or std::isinf(y1))
-                // that means that the coordinate is not applicable to the series, just ignore this point
-                continue;
-            x.append (x1);
-            xmin = std::min (xmin, x1);
-            xmax = std::max (xmax, x1);
-            y.append (y1);
-            ymin = std::min (ymin, y1);
-            ymax = std::max (ymax, y1);
+        x.reserve(store.nLiveRows());
+        y.reserve(store.nLiveRows());
+
+        for (int b = 0; b < store.nBlocks(); ++b) {
+            // the columns are read right from the mapped file
+            const Span <const double> xs = store.column(b, axisX), ys = store.column(b, axisY);
+            for (int r = 0; r < store.blockRows(b); ++r) {
+                if (not store.isLive(b, r))
+                    continue;
+                ui->progressBar->setValue(progress++);
+                if (progress % 20 == 0)
+                    QApplication::processEvents();
+                const double x1 = xs[r], y1 = ys[r];
+                if (std::isnan(x1) or std::isnan(y1) or std::isinf(x1) or std::isinf(y1))
+                    // that means that the coordinate is not applicable to the series, just ignore this point
+                    continue;
+                if (not got_ranges) {
+                    // the first point sets starting values for x and y ranges
+                    xmin = xmax = x1;
+                    ymin = ymax = y1;
+                    got_ranges = true;
+                }
+                x.append (x1);
+                xmin = std::min (xmin, x1);
+                xmax = std::max (xmax, x1);
+                y.append (y1);
+                ymin = std::min (ymin, y1);
+                ymax = std::max (ymax, y1);
+            }
         }
 
         graph->setData(y, x);
@@ -4,6 +4,10 @@
 #include <QDir>
 #include <QWidget>
 
+#include <memory>
+
+#include "CoordinatesStore.h"
+
 namespace Ui {
 class Plot;
 }
@@ -34,16 +38,16 @@ private slots:
 private:
     Ui::Plot *ui;
     QwtPlot* plot;
-    /// A file containing data to plot
+    /// A store containing data to plot
     struct colouredFiles {
-        QList <QString> fnames; ///< the name of the files with coordinates
-        QDir dir;
-        QColor colour; ///< the colour for point corresponding to the files
+        std::shared_ptr <const CoordinatesStore> store; ///< the coordinates of the series of a directory
+        QColor colour; ///< the colour for point corresponding to the series
     };
-    /// Enumerate files that contain coordinates to plot
+    /// Enumerate the stores that contain coordinates to plot, the .coords files are read
+    /// into memory where there is no store
     /// Call `excludedFiles.clear()` before using this function
     /// @param[in] dir where to read files from
-    /// @param[out] How many files are there totally (recursively)
+    /// @param[out] How many series are there totally (recursively)
     QList <colouredFiles> getAllFiles (const QDir& dir, int &nFiles);
 };
 
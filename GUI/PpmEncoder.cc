@@ -0,0 +1,111 @@
+#include "PpmEncoder.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr int PpmEncoder::maxOrder;
+
+namespace {
+constexpr int initialTableLog = 12;
+
+/// The key of the context of the @p order made of the last bytes @p history
+uint64_t contextKey (uint64_t history, int order) {
+    const uint64_t bytes = order == 0 ? 0 : history & ((uint64_t (1) << (8 * order)) - 1);
+    return bytes | uint64_t (order) << 57;
+}
+
+/// The key of the @p byte following the context @p context
+uint64_t symbolKey (uint64_t context, uint8_t byte) {
+    return context | (uint64_t (byte) + 1) << 48;
+}
+}
+
+qint64 PpmEncoder::compressedSize(const void* data, qint64 size) {
+    const auto bytes = static_cast <const uint8_t*> (data);
+    const int order = std::min (maxOrder, 2 + _Level / 3 + (_Extreme ? 1 : 0));
+
+    if (_Table.empty()) {
+        _Table.resize(size_t (1) << initialTableLog);
+        _Shift = 64 - initialTableLog;
+    }
+    // a new stamp invalidates all the entries, when it wraps the entries are cleared for real
+    if (++_Stamp == 0) {
+        std::fill (_Table.begin(), _Table.end(), entry_t ());
+        _Stamp = 1;
+    }
+    _Used = 0;
+
+    double bits = 0.;
+    uint64_t history = 0;
+    for (qint64 i = 0; i < size; ++i) {
+        const uint8_t byte = bytes[i];
+        const int top = static_cast <int> (std::min <qint64> (order, i));
+
+        // code the byte from the longest context down, escaping from the ones it is new to
+        bool coded = false;
+        for (int o = top; o >= 0 and not coded; --o) {
+            const uint64_t context = contextKey (history, o);
+            // copies: the table may grow on the next look-up
+            const entry_t stats = _Find (context);
+            if (stats.count == 0)
+                continue;
+            const double total = stats.count + stats.distinct;
+            const uint32_t count = _Find (symbolKey (context, byte)).count;
+            if (count > 0) {
+                bits += log2 (total / count);
+                coded = true;
+            } else {
+                bits += log2 (total / stats.distinct);
+            }
+        }
+        if (not coded) {
+            // a new byte, any of the ones not seen yet
+            const uint32_t seen = i > 0 ? _Find (contextKey (history, 0)).distinct : 0;
+            bits += log2 (256. - seen);
+        }
+
+        for (int o = top; o >= 0; --o) {
+            const uint64_t context = contextKey (history, o);
+            const bool isNew = _Find (symbolKey (context, byte)).count++ == 0;
+            entry_t& stats = _Find (context);
+            ++stats.count;
+            stats.distinct += isNew;
+        }
+        history = history << 8 | byte;
+    }
+    return static_cast <qint64> (ceil (bits / 8));
+}
+
+PpmEncoder::entry_t& PpmEncoder::_Find(uint64_t key) {
+    if (2 * (_Used + 1) > _Table.size())
+        _Grow ();
+    size_t i = (key * 0x9E3779B97F4A7C15ull) >> _Shift;
+    const size_t mask = _Table.size() - 1;
+    for (;; i = (i + 1) & mask) {
+        entry_t& e = _Table[i];
+        if (e.stamp != _Stamp) {
+            e.key = key;
+            e.stamp = _Stamp;
+            e.count = e.distinct = 0;
+            ++_Used;
+            return e;
+        }
+        if (e.key == key)
+            return e;
+    }
+}
+
+void PpmEncoder::_Grow() {
+    std::vector <entry_t> old (_Table.size() * 2);
+    old.swap(_Table);
+    --_Shift;
+    const size_t mask = _Table.size() - 1;
+    for (const entry_t& e : old) {
+        if (e.stamp != _Stamp)
+            continue;
+        size_t i = (e.key * 0x9E3779B97F4A7C15ull) >> _Shift;
+        while (_Table[i].stamp == _Stamp)
+            i = (i + 1) & mask;
+        _Table[i] = e;
+    }
+}
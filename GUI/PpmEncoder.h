@@ -0,0 +1,48 @@
+#ifndef PPMENCODER_H_0f7b3d92_c4a8_41e6_b52d_93e8a1c6f04b
+#define PPMENCODER_H_0f7b3d92_c4a8_41e6_b52d_93e8a1c6f04b
+
+#include <cstdint>
+#include <vector>
+
+#include "Compressor.h"
+
+/**
+ * @brief Prediction by partial matching: the code length of an order-k arithmetic coder.
+ *
+ * Each byte is predicted by the statistics of the contexts of the orders k, k - 1, ..., 0
+ * with the escapes of the method C, a byte never seen before is any of the rest equally likely.
+ * The size is the total of -log2 of the predicted probabilities, the length
+ * an arithmetic coder would approach, so nothing is actually written.
+ * The order is 2 + level / 3, one more if extreme, at most @c maxOrder.
+ *
+ * The statistics live in one open addressing hash table; entries are marked
+ * with the number of the data they belong to, so resetting the table
+ * for the next data takes no time and the table only grows.
+ */
+class PpmEncoder : public Compressor {
+public:
+    static constexpr int maxOrder = 6;
+
+    qint64 compressedSize (const void* data, qint64 size) override;
+
+private:
+    struct entry_t {
+        uint64_t key;
+        /// The number of the data the entry is valid for
+        uint32_t stamp = 0;
+        /// A context: how many times it occurred and how many distinct bytes followed it;
+        /// a byte in a context: how many times, the second value is unused
+        uint32_t count, distinct;
+    };
+
+    /// The entry with the @p key, a new zero one if there is none
+    entry_t& _Find (uint64_t key);
+    void _Grow ();
+
+    std::vector <entry_t> _Table;
+    int _Shift = 64;
+    size_t _Used = 0;
+    uint32_t _Stamp = 0;
+};
+
+#endif // PPMENCODER_H
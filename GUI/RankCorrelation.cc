@@ -0,0 +1,281 @@
+#include "RankCorrelation.h"
+#include "CoordinatesStore.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+
+namespace {
+constexpr double NaN = std::numeric_limits <double>::quiet_NaN();
+
+/// The rows below it are sorted by insertion before the merges
+constexpr int insertionRun = 32;
+
+inline int64_t nPairs (int64_t n) noexcept {
+    return n * (n - 1) / 2;
+}
+
+/// The number of the pairs of equal values in the sorted @p v of @p n
+int64_t tiedPairs (const double* v, int n) {
+    int64_t ans = 0;
+    for (int k = 0; k < n;) {
+        int e = k + 1;
+        while (e < n and v[e] == v[k])
+            ++e;
+        ans += nPairs (e - k);
+        k = e;
+    }
+    return ans;
+}
+
+/**
+ * @brief sort @p v of @p n, counting the swaps of the neighbours a bubble sort would make,
+ *  i.e. the pairs of the values in the wrong order, the equal ones are not.
+ * @param buffer @p n values to merge into
+ * @return where the values sorted are: @p v or @p buffer
+ */
+double* sortCountingSwaps (double* v, double* buffer, int n, int64_t& swaps) {
+    swaps = 0;
+    for (int begin = 0; begin < n; begin += insertionRun) {
+        const int end = std::min (begin + insertionRun, n);
+        for (int k = begin + 1; k < end; ++k) {
+            const double value = v[k];
+            int l = k;
+            for (; l > begin and v[l - 1] > value; --l)
+                v[l] = v[l - 1];
+            swaps += k - l;
+            v[l] = value;
+        }
+    }
+    double* from = v;
+    double* to = buffer;
+    for (int width = insertionRun; width < n; width *= 2) {
+        for (int begin = 0; begin < n; begin += 2 * width) {
+            const int middle = std::min (begin + width, n),
+                      end = std::min (begin + 2 * width, n);
+            int a = begin, b = middle, k = begin;
+            while (a < middle and b < end) {
+                if (from[b] < from[a]) {
+                    // it jumps over all the rest of the left run
+                    swaps += middle - a;
+                    to[k++] = from[b++];
+                } else {
+                    to[k++] = from[a++];
+                }
+            }
+            std::copy (from + a, from + middle, to + k);
+            std::copy (from + b, from + end, to + k + (middle - a));
+        }
+        std::swap (from, to);
+    }
+    return from;
+}
+}
+
+RankCorrelation::RankCorrelation(const CoordinatesStore& store, int nThreads) :
+    _NThreads (nThreads > 0 ? nThreads : std::max (1, static_cast <int> (std::thread::hardware_concurrency()))),
+    _NRows (store.nLiveRows()) {
+    const bool allLive = store.nLiveRows() == store.nRows();
+    for (size_t c = 0; c < coordinates_t::nValues; ++c) {
+        _Values[c].reserve(_NRows);
+        for (int b = 0; b < store.nBlocks(); ++b) {
+            const Span <const double> column = store.column(b, c);
+            if (allLive) {
+                _Values[c].insert(_Values[c].end(), column.begin(), column.end());
+                continue;
+            }
+            for (int r = 0; r < store.blockRows(b); ++r)
+                if (store.isLive(b, r))
+                    _Values[c].push_back(column[r]);
+        }
+    }
+
+    // one sort per coordinate, all of them at once
+    const QVector <qint64> costs (coordinates_t::nValues, std::max (_NRows, 1));
+    TaskPool pool (costs, [this](int c){
+        const double* v = _Values[c].data();
+        // the values go along with the rows, the comparisons don't jump over the memory
+        std::vector <std::pair <double, int>> sorted;
+        sorted.reserve(_NRows);
+        for (int r = 0; r < _NRows; ++r)
+            if (not std::isnan (v[r]))
+                sorted.emplace_back(v[r], r);
+        std::sort (sorted.begin(), sorted.end());
+        std::vector <int>& order = _Order[c];
+        order.resize(sorted.size());
+        for (size_t k = 0; k < sorted.size(); ++k)
+            order[k] = sorted[k].second;
+        if (_IsComplete (c)) {
+            _Ranks[c].resize(_NRows);
+            _Rank (v, order, _Ranks[c].data());
+        }
+    }, std::min (_NThreads, static_cast <int> (coordinates_t::nValues)));
+    while (not pool.wait(100))
+        ;
+}
+
+void RankCorrelation::_Rank(const double* v, const std::vector <int>& order, double* ranks) {
+    const int n = order.size();
+    for (int k = 0; k < n;) {
+        int e = k + 1;
+        while (e < n and v[order[e]] == v[order[k]])
+            ++e;
+        // the ties share the mean of the ranks k + 1 .. e
+        const double rank = (k + 1 + e) / 2.;
+        for (; k < e; ++k)
+            ranks[order[k]] = rank;
+    }
+}
+
+double RankCorrelation::spearman(size_t i, size_t j) const {
+    _Scratch scratch;
+    return _Spearman (i, j, scratch);
+}
+
+double RankCorrelation::kendall(size_t i, size_t j) const {
+    _Scratch scratch;
+    return _Kendall (i, j, scratch);
+}
+
+double RankCorrelation::_Spearman(size_t i, size_t j, _Scratch& scratch) const {
+    const double* x;
+    const double* y;
+    const int* rows = nullptr;
+    int m = _NRows;
+    if (_IsComplete (i) and _IsComplete (j)) {
+        x = _Ranks[i].data();
+        y = _Ranks[j].data();
+    } else {
+        // the rows having both coordinates, ranked among themselves
+        const double* vi = _Values[i].data();
+        const double* vj = _Values[j].data();
+        scratch.rowsX.clear();
+        for (int r : _Order[i])
+            if (not std::isnan (vj[r]))
+                scratch.rowsX.push_back(r);
+        scratch.rowsY.clear();
+        for (int r : _Order[j])
+            if (not std::isnan (vi[r]))
+                scratch.rowsY.push_back(r);
+        scratch.x.resize(_NRows);
+        scratch.y.resize(_NRows);
+        _Rank (vi, scratch.rowsX, scratch.x.data());
+        _Rank (vj, scratch.rowsY, scratch.y.data());
+        x = scratch.x.data();
+        y = scratch.y.data();
+        rows = scratch.rowsX.data();
+        m = scratch.rowsX.size();
+    }
+    if (m < 2)
+        return NaN;
+
+    // the mean of the mid-ranks is that of 1 .. m whatever the ties are
+    const double mean = (m + 1) / 2.;
+    double sxy = 0., sxx = 0., syy = 0.;
+    for (int k = 0; k < m; ++k) {
+        const int r = rows != nullptr ? rows[k] : k;
+        const double dx = x[r] - mean,
+                     dy = y[r] - mean;
+        sxy += dx * dy;
+        sxx += dx * dx;
+        syy += dy * dy;
+    }
+    return sxy / std::sqrt (sxx * syy);
+}
+
+double RankCorrelation::_Kendall(size_t i, size_t j, _Scratch& scratch) const {
+    // the rows having both coordinates sorted by the first one
+    const double* vi = _Values[i].data();
+    const double* vj = _Values[j].data();
+    scratch.x.resize(_NRows);
+    scratch.y.resize(_NRows);
+    scratch.buffer.resize(_NRows);
+    double* x = scratch.x.data();
+    double* y = scratch.y.data();
+    int m = 0;
+    for (int r : _Order[i]) {
+        if (std::isnan (vj[r]))
+            continue;
+        x[m] = vi[r];
+        y[m] = vj[r];
+        ++m;
+    }
+    if (m < 2)
+        return NaN;
+
+    // then by the second one within the ties of the first one
+    int64_t tiedX = 0, tiedXY = 0;
+    for (int k = 0; k < m;) {
+        int e = k + 1;
+        while (e < m and x[e] == x[k])
+            ++e;
+        if (e - k > 1) {
+            std::sort (y + k, y + e);
+            tiedX += nPairs (e - k);
+            tiedXY += tiedPairs (y + k, e - k);
+        }
+        k = e;
+    }
+
+    // the rest of the pairs in the wrong order by the second coordinate are discordant
+    int64_t discordant = 0;
+    const double* sorted = sortCountingSwaps (y, scratch.buffer.data(), m, discordant);
+    const int64_t tiedY = tiedPairs (sorted, m);
+
+    const int64_t n0 = nPairs (m);
+    const double S = static_cast <double> (n0 - tiedX - tiedY + tiedXY - 2 * discordant);
+    return S / std::sqrt (static_cast <double> (n0 - tiedX) * static_cast <double> (n0 - tiedY));
+}
+
+QVector <double> RankCorrelation::correlations(CorrelationMethod method) const {
+    assert (method != CorrelationMethod::pearson);
+    const size_t n = coordinates_t::nValues;
+    QVector <int> pairs;
+    for (size_t i = 0; i < n; ++i)
+        for (size_t j = i; j < n; ++j)
+            pairs.append(i * n + j);
+    const QVector <qint64> costs (pairs.size(), std::max (_NRows, 1));
+
+    QVector <double> ans (n * n);
+    std::vector <_Scratch> scratch (std::min (_NThreads, pairs.size()));
+    {
+        TaskPool pool (costs, [this, method, n, &pairs, &ans, &scratch](int k){
+            const size_t i = pairs[k] / n,
+                         j = pairs[k] % n;
+            _Scratch& s = scratch[TaskPool::workerId()];
+            ans[i * n + j] = ans[j * n + i] = method == CorrelationMethod::kendall ? _Kendall (i, j, s)
+                                                                                  : _Spearman (i, j, s);
+        }, scratch.size());
+        while (not pool.wait(100))
+            ;
+    }
+    return ans;
+}
+
+const char* RankCorrelation::name(CorrelationMethod method) {
+    switch (method) {
+    case CorrelationMethod::pearson:  return "Пирсона";
+    case CorrelationMethod::spearman: return "Спирмена";
+    case CorrelationMethod::kendall:  return "Кендалла";
+    }
+    return "???";
+}
+
+const char* RankCorrelation::id(CorrelationMethod method) {
+    switch (method) {
+    case CorrelationMethod::pearson:  return "pearson";
+    case CorrelationMethod::spearman: return "spearman";
+    case CorrelationMethod::kendall:  return "kendall";
+    }
+    return "???";
+}
+
+QVector <CorrelationMethod> RankCorrelation::methods() {
+    return QVector <CorrelationMethod> {CorrelationMethod::pearson, CorrelationMethod::spearman,
+                                        CorrelationMethod::kendall};
+}
@@ -0,0 +1,86 @@
+#ifndef RANKCORRELATION_H_a3f81c56_2d97_4e0b_8c14_69e5b7d0f283
+#define RANKCORRELATION_H_a3f81c56_2d97_4e0b_8c14_69e5b7d0f283
+
+#include <vector>
+
+#include <QVector>
+
+#include "Coordinates.h"
+
+class CoordinatesStore;
+
+/// How the coordinates are correlated
+enum class CorrelationMethod {
+    /// the linear correlation of the values, see @c CoMoments
+    pearson,
+    /// the Pearson correlation of the ranks
+    spearman,
+    /// Kendall's tau-b, the share of the concordant pairs of rows less the discordant ones
+    kendall
+};
+
+/**
+ * @brief The rank correlations of the coordinates of a set, which heavy tails don't mislead.
+ *
+ * The live rows of the store are gathered and the rows of each coordinate having it
+ * are sorted by its values once, the coordinates in parallel. Every pair of coordinates
+ * is then over the rows having both of them, as for @c CoMoments:
+ *  - the Spearman correlation is the Pearson one of the mid-ranks of the two coordinates,
+ *    taken by walking the sorted rows in O(n), and of the ranks found beforehand
+ *    if neither of them has NaN;
+ *  - Kendall's tau-b is by Knight's algorithm in O(n log n): the rows sorted by the first
+ *    coordinate, and by the second one within its ties, are merge-sorted by the second
+ *    coordinate counting the swaps, which are the discordant pairs.
+ * The pairs are shared by the workers.
+ */
+class RankCorrelation {
+public:
+    /**
+     * @brief gather and sort the live rows of the @p store.
+     * @param nThreads how many threads to run, 0 for one per core
+     */
+    explicit RankCorrelation (const CoordinatesStore& store, int nThreads = 0);
+
+    /// How many rows there are, NaN or not
+    int nRows () const noexcept { return _NRows; }
+
+    /// The Spearman correlation of the coordinates @p i and @p j, NaN if one of them is constant
+    double spearman (size_t i, size_t j) const;
+    /// Kendall's tau-b of the coordinates @p i and @p j, NaN if one of them is constant
+    double kendall (size_t i, size_t j) const;
+    /// The nValues × nValues matrix by rows of the @c spearman or @c kendall correlations
+    QVector <double> correlations (CorrelationMethod method) const;
+
+    /// User-readable method name (in Russian)
+    static const char* name (CorrelationMethod method);
+    /// Machine-readable method name
+    static const char* id (CorrelationMethod method);
+    /// All the methods, the original one first
+    static QVector <CorrelationMethod> methods ();
+
+private:
+    /// The buffers of a worker, @c nRows each
+    struct _Scratch {
+        std::vector <double> x, y, buffer;
+        std::vector <int> rowsX, rowsY;
+    };
+    /// Whether the coordinate @p c has no NaN
+    bool _IsComplete (size_t c) const noexcept {
+        return static_cast <int> (_Order[c].size()) == _NRows;
+    }
+    /// The mid-ranks of the rows in @p order by the values @p v, into @p ranks by the rows
+    static void _Rank (const double* v, const std::vector <int>& order, double* ranks);
+    double _Spearman (size_t i, size_t j, _Scratch& scratch) const;
+    double _Kendall (size_t i, size_t j, _Scratch& scratch) const;
+
+    int _NThreads;
+    int _NRows = 0;
+    /// The live rows by the coordinates
+    std::vector <double> _Values[coordinates_t::nValues];
+    /// The rows having the coordinate, by its values
+    std::vector <int> _Order[coordinates_t::nValues];
+    /// The mid-ranks of the coordinates having no NaN, by the rows
+    std::vector <double> _Ranks[coordinates_t::nValues];
+};
+
+#endif // RANKCORRELATION_H
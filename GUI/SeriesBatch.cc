@@ -0,0 +1,218 @@
+#include "SeriesBatch.h"
+#include "Fourier.h"
+#include "SeriesKernels.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <limits>
+
+using std::fabs;
+
+constexpr int SeriesBatch::maxSeries;
+constexpr int SeriesBatch::maxValues;
+
+namespace {
+/// How many samples of all the lanes a batched Fourier transform takes at most
+/// before its work vectors outgrow the cache and cost more than the shared butterflies save
+constexpr int fftValues = 1 << 14;
+}
+
+SeriesBatch::SeriesBatch(int nSeries, int length)
+    : _NSeries (nSeries), _Length (length), _Values (nSeries * length, 0.f) {
+}
+
+void SeriesBatch::setSeries(int series, const float* values) {
+    for (int i = 0; i < _Length; ++i)
+        _Values[i * _NSeries + series] = values[i];
+    dirty = true;
+}
+
+const TimeSeries::statistics_t& SeriesBatch::statistics(int series) const {
+    if (dirty)
+        _Encode();
+    return _Statistics[series];
+}
+
+const QVector <uint8_t>& SeriesBatch::encoded() const {
+    if (dirty)
+        _Encode();
+    return _Codes;
+}
+
+void SeriesBatch::_Encode() const {
+    const int K = _NSeries,
+              n = _Length;
+    _Statistics.resize(K);
+    _Codes.resize(_Values.size());
+    _Tendency.resize(_Values.size());
+    dirty = false;
+    if (n == 0) {
+        _Statistics.fill(TimeSeries::statistics_t {0.f, 0.f, 0., 0., 0.});
+        return;
+    }
+
+    QVector <float> inf (K), sup (K), step (K);
+    QVector <double> sum (K), mean (K), variance (K), range (K);
+    minMaxSumLanes (_Values.constData(), n, K, inf.data(), sup.data(), sum.data());
+    for (int s = 0; s < K; ++s) {
+        mean[s] = sum[s] / n;
+        const float st = (sup[s] - inf[s]) / _NLevels;
+        // all the values of a constant series are inf, so any step gives them the code 0
+        step[s] = st > 0 ? st : 1.f;
+    }
+
+    encodeLanes (_Values.constData(), n, K, inf.constData(), step.constData(), _NLevels - 1,
+                 mean.constData(), _Codes.data(), _Tendency.data(), variance.data(), range.data());
+    for (int s = 0; s < K; ++s)
+        _Statistics[s] = TimeSeries::statistics_t {inf[s], sup[s], mean[s], variance[s], range[s]};
+}
+
+SeriesBatch SeriesBatch::tendencySeries() const {
+    SeriesBatch ans (_NSeries, _Length);
+    ans.setNLevels(3);
+    if (_Length > 0) {
+        encoded();
+        ans._Values = _Tendency;
+    }
+    return ans;
+}
+
+QVector <double> SeriesBatch::harmonicComplexity() const {
+    const int K = _NSeries,
+              n = _Length;
+    QVector <double> ans (K, 0.);
+    if (n / 2 == 0)
+        return ans;
+
+    // the same float means as in TimeSeries::harmonicComplexity
+    QVector <float> avg (K);
+    for (int s = 0; s < K; ++s)
+        avg[s] = statistics(s).mean;
+
+    // the lanes go through every butterfly together by chunks, a lane at a time for the long series
+    const int period = n - 1,
+              chunk = std::max (1, std::min (K, fftValues / period));
+    const auto plan = RealFFT::plan(period);
+    QVector <double> y (period * chunk);
+    QVector <RealFFT::complex> spectrum ((period / 2 + 1) * chunk);
+    QVector <double> R (n / 2);
+    for (int begin = 0; begin < K; begin += chunk) {
+        const int m = std::min (chunk, K - begin);
+        // trapezoid-weighted detrended samples, still interleaved
+        const float* __restrict a = avg.constData() + begin;
+        for (int s = 0; s < m; ++s)
+            y[s] = ((value (0, begin + s) - a[s]) + (value (n - 1, begin + s) - a[s])) / 2.;
+        for (int i = 1; i < period; ++i) {
+            const float* __restrict v = row (i) + begin;
+            double* __restrict out = y.data() + i * m;
+            for (int s = 0; s < m; ++s)
+                out[s] = v[s] - a[s];
+        }
+        plan->transform(y.constData(), spectrum.data(), m);
+
+        for (int s = 0; s < m; ++s) {
+            for (int k = 0; k < n / 2; ++k) {
+                const RealFFT::complex& x = spectrum[k * m + s];
+                double A = fabs (2. / period * x.real()),
+                       B = fabs (2. / period * x.imag());
+                R[k] = sqrt (A * A + B * B);
+            }
+            ans[begin + s] = TimeSeries::_HarmonicComplexity (R);
+        }
+    }
+    return ans;
+}
+
+QVector <double> SeriesBatch::herstValue(HurstEstimator method) const {
+    const int K = _NSeries,
+              n = _Length;
+    QVector <double> ans (K, std::numeric_limits<double>::quiet_NaN());
+    if (n < 2)
+        return ans;
+
+    if (method != HurstEstimator::wholeSeries) {
+        // the estimators go over the windows of a series, so they take it as a whole
+        QVector <float> column (n);
+        for (int s = 0; s < K; ++s) {
+            for (int i = 0; i < n; ++i)
+                column[i] = value (i, s);
+            ans[s] = HurstEngine (column.constData(), n).estimate(method);
+        }
+        return ans;
+    }
+
+    for (int s = 0; s < K; ++s) {
+        const auto& stats = statistics(s);
+        double R = stats.range;
+        double S = sqrt (stats.variance);
+        ans[s] = log (R/S) / log(n);
+    }
+    return ans;
+}
+
+void SeriesBatch::shareEncoding(int series, TimeSeries& ts) const {
+    assert (ts.size() == _Length and CodeSpan::widthFor(_NLevels) == 1);
+    const int K = _NSeries,
+              n = _Length;
+    const auto& codes = encoded();
+    ts._NLevels = _NLevels;
+    ts._CodeWidth = 1;
+    ts._Codes.resize(n);
+    ts._Tendency.resize(n);
+    for (int i = 0; i < n; ++i) {
+        ts._Codes[i] = codes[i * K + series];
+        ts._Tendency[i] = _Tendency[i * K + series];
+    }
+    ts._Statistics = _Statistics[series];
+    ts._Deviations.clear();
+    ts._Words.clear();
+    ts.dirty = false;
+}
+
+namespace {
+/// The indices of the coordinates @c SeriesBatch::fill computes
+struct batchCoordinates_t {
+    size_t harmonic, fractal, tendencyHarmonic, tendencyFractal;
+
+    batchCoordinates_t () {
+        const coordinates_t c {};
+        const auto& v = c.by_name;
+        harmonic = &v.harmonicComplexity - c.values;
+        fractal = &v.fractalDimensionality - c.values;
+        tendencyHarmonic = &v.tendencyHarmonicComplexity - c.values;
+        tendencyFractal = &v.tendencyFractalDimensionality - c.values;
+    }
+};
+}
+
+std::bitset <coordinates_t::nValues> SeriesBatch::metrics() {
+    const batchCoordinates_t index;
+    std::bitset <coordinates_t::nValues> ans;
+    ans.set(index.harmonic);
+    ans.set(index.fractal);
+    ans.set(index.tendencyHarmonic);
+    ans.set(index.tendencyFractal);
+    return ans;
+}
+
+void SeriesBatch::fill(coordinates_t* coords, const std::bitset <coordinates_t::nValues>& wanted,
+                       HurstEstimator method) const {
+    const batchCoordinates_t index;
+    auto fillOf = [coords, &wanted, method](const SeriesBatch& batch, size_t harmonic, size_t fractal) {
+        if (wanted[harmonic]) {
+            const auto complexity = batch.harmonicComplexity();
+            for (int s = 0; s < batch.nSeries(); ++s)
+                coords[s].values[harmonic] = complexity[s];
+        }
+        if (wanted[fractal]) {
+            const auto herst = batch.herstValue(method);
+            for (int s = 0; s < batch.nSeries(); ++s)
+                coords[s].values[fractal] = 2 - herst[s];
+        }
+    };
+
+    fillOf (*this, index.harmonic, index.fractal);
+    if (wanted[index.tendencyHarmonic] or wanted[index.tendencyFractal])
+        fillOf (tendencySeries(), index.tendencyHarmonic, index.tendencyFractal);
+}
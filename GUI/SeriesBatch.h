@@ -0,0 +1,100 @@
+#ifndef SERIESBATCH_H_4edb1025_07f2_49fa_85da_38a87d6f967f
+#define SERIESBATCH_H_4edb1025_07f2_49fa_85da_38a87d6f967f
+
+#include <QVector>
+
+#include <bitset>
+
+#include "Coordinates.h"
+#include "Hurst.h"
+#include "TimeSeries.h"
+
+/**
+ * @brief A set of time series of the same length processed all at once.
+ *
+ * The values are stored as a structure of arrays: the i-th values of all
+ * the series go one after another, @c value(i, s) is at @c i * nSeries() + s.
+ * Thus every loop over time runs over @c nSeries() independent lanes
+ * and vectorizes even if the series themselves are too short for that,
+ * the Fourier transforms included.
+ *
+ * The metrics are the same to the bit as the ones of @c TimeSeries for each of the series.
+ * The codes take a byte each, so @c nLevels() is at most 256, see @c CodeSpan.
+ */
+class SeriesBatch {
+public:
+    /// How many series a batch takes at most
+    static constexpr int maxSeries = 64;
+    /// How many values of all the series a batch should hold for its rows to stay in the cache
+    static constexpr int maxValues = 1 << 16;
+
+    SeriesBatch (int nSeries = 0, int length = 0);
+
+    int nSeries () const noexcept { return _NSeries; }
+    int length () const noexcept { return _Length; }
+
+    float value (int i, int series) const {
+        return _Values[i * _NSeries + series];
+    }
+    /// All the series' values at the moment @p i
+    const float* row (int i) const {
+        return _Values.constData() + i * _NSeries;
+    }
+    /// Replace the series number @p series with @c length() values from @p values
+    void setSeries (int series, const float* values);
+
+    unsigned nLevels () const noexcept {
+        return _NLevels;
+    }
+    void setNLevels (unsigned n) noexcept {
+        _NLevels = n;
+        dirty = true;
+    }
+
+    /// see @c TimeSeries::statistics
+    const TimeSeries::statistics_t& statistics (int series) const;
+    /// Codes of all the series in the same layout as the values, see @c TimeSeries::encoded
+    const QVector <uint8_t>& encoded () const;
+    /// Tendency series of all the series, see @c TimeSeries::tendencySeries
+    SeriesBatch tendencySeries () const;
+
+    /// see @c TimeSeries::harmonicComplexity
+    QVector <double> harmonicComplexity () const;
+    /// see @c TimeSeries::herstValue
+    QVector <double> herstValue (HurstEstimator method = HurstEstimator::wholeSeries) const;
+
+    /**
+     * @brief hand the statistics, the codes and the tendency of the series number @p series
+     *  over to @p ts, so that it does not encode them again.
+     * @param ts the same values as the series, @c nLevels() is set to the batch's one
+     */
+    void shareEncoding (int series, TimeSeries& ts) const;
+
+    /// The coordinates @c fill computes
+    static std::bitset <coordinates_t::nValues> metrics ();
+    /**
+     * @brief store the coordinates that do not need a compressor nor a word search
+     *
+     * Sets harmonic complexity and fractal dimensionality of the series
+     * and of their tendency series, if they are among the @p wanted ones;
+     * the other coordinates are left as they are.
+     * @param coords @c nSeries() coordinates
+     */
+    void fill (coordinates_t* coords, const std::bitset <coordinates_t::nValues>& wanted,
+               HurstEstimator method = HurstEstimator::wholeSeries) const;
+
+private:
+    int _NSeries, _Length;
+    unsigned _NLevels = 8;
+    QVector <float> _Values;
+    mutable QVector <TimeSeries::statistics_t> _Statistics;
+    mutable QVector <uint8_t> _Codes;
+    /// Values of the @c tendencySeries() in the same layout, derived from @c _Codes
+    mutable QVector <float> _Tendency;
+    mutable bool dirty = true;
+
+    /// The lane by lane @c TimeSeries::_Encode, see @c minMaxSumLanes and @c encodeLanes
+    void _Encode () const;
+};
+
+#endif // SERIESBATCH_H
@@ -0,0 +1,115 @@
+#include "SeriesFile.h"
+
+#include <QtGlobal>
+
+#include <climits>
+#include <cstring>
+
+static_assert (Q_BYTE_ORDER == Q_LITTLE_ENDIAN,
+               "the .tsb payload is mapped as is, so only little-endian hosts are supported");
+static_assert (sizeof (SeriesFile::header_t) == 32, "the header must be packed");
+
+namespace {
+constexpr char magic[4] = {'T', 'S', 'B', '\x1a'};
+
+template <typename T>
+uint32_t dtypeOf ();
+template <>
+uint32_t dtypeOf <float> () { return SeriesFile::float32; }
+template <>
+uint32_t dtypeOf <double> () { return SeriesFile::float64; }
+
+template <typename T>
+bool writeSeries (const QString& fileName,
+                  Span <const T> values,
+                  const QVector <double>& coefficients) {
+    QFile file (fileName);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    SeriesFile::header_t header;
+    memcpy (header.magic, magic, sizeof (magic));
+    header.version = SeriesFile::currentVersion;
+    header.dtype = dtypeOf <T> ();
+    header.nCoefficients = coefficients.size();
+    header.length = values.size();
+    const qint64 coefficientsEnd = sizeof (header) + coefficients.size() * sizeof (double);
+    header.payloadOffset = (coefficientsEnd + SeriesFile::alignment - 1)
+                           / SeriesFile::alignment * SeriesFile::alignment;
+
+    const QByteArray padding (static_cast <int> (header.payloadOffset - coefficientsEnd), '\0');
+    const qint64 payloadSize = values.size() * static_cast <qint64> (sizeof (T));
+    return file.write(reinterpret_cast <const char*> (&header), sizeof (header)) == sizeof (header)
+       and file.write(reinterpret_cast <const char*> (coefficients.constData()),
+                      coefficients.size() * sizeof (double))
+           == static_cast <qint64> (coefficients.size() * sizeof (double))
+       and file.write(padding) == padding.size()
+       and file.write(reinterpret_cast <const char*> (values.data()), payloadSize) == payloadSize;
+}
+}
+
+SeriesFile::SeriesFile(const QString& fileName)
+    : _File (fileName) {
+    if (not _File.open(QIODevice::ReadOnly))
+        return;
+    const qint64 fileSize = _File.size();
+    if (fileSize < static_cast <qint64> (sizeof (header_t)))
+        return;
+    const uchar* data = _File.map(0, fileSize);
+    if (not data)
+        return;
+
+    header_t header;
+    memcpy (&header, data, sizeof (header));
+    if (memcmp (header.magic, magic, sizeof (magic)) != 0
+        or header.version != currentVersion
+        or (header.dtype != float32 and header.dtype != float64)
+        or header.length > INT_MAX)
+        return;
+
+    const quint64 itemSize = header.dtype == float32 ? sizeof (float) : sizeof (double);
+    const quint64 coefficientsEnd = sizeof (header) + quint64 (header.nCoefficients) * sizeof (double);
+    if (header.payloadOffset % alignment != 0
+        or header.payloadOffset < coefficientsEnd
+        // the sum of a corrupt offset and the size would wrap around
+        or header.payloadOffset > static_cast <quint64> (fileSize)
+        or header.length * itemSize > static_cast <quint64> (fileSize) - header.payloadOffset)
+        return;
+
+    _Coefficients.resize(header.nCoefficients);
+    memcpy (_Coefficients.data(), data + sizeof (header), header.nCoefficients * sizeof (double));
+
+    const int n = header.length;
+    const uchar* payload = data + header.payloadOffset;
+    if (header.dtype == float32) {
+        _Values = Span <const float> (reinterpret_cast <const float*> (payload), n);
+    } else {
+        const double* wide = reinterpret_cast <const double*> (payload);
+        _Converted.resize(n);
+        for (int i = 0; i < n; ++i)
+            _Converted[i] = wide[i];
+        _Values = Span <const float> (_Converted.constData(), n);
+    }
+    _Valid = true;
+}
+
+bool SeriesFile::isSeriesFile(const QString& fileName) {
+    QFile file (fileName);
+    if (not file.open(QIODevice::ReadOnly))
+        return false;
+    char signature[sizeof (magic)];
+    return file.read(signature, sizeof (signature)) == sizeof (signature)
+       and memcmp (signature, magic, sizeof (magic)) == 0;
+}
+
+bool SeriesFile::write(const QString& fileName,
+                       Span <const float> values,
+                       const QVector <double>& coefficients) {
+    return writeSeries (fileName, values, coefficients);
+}
+
+bool SeriesFile::write(const QString& fileName,
+                       Span <const double> values,
+                       const QVector <double>& coefficients) {
+    return writeSeries (fileName, values, coefficients);
+}
@@ -0,0 +1,79 @@
+#ifndef SERIESFILE_H_5a0c7e41_2f9b_4d36_8e1a_9b47c3d2f815
+#define SERIESFILE_H_5a0c7e41_2f9b_4d36_8e1a_9b47c3d2f815
+
+#include <cstdint>
+
+#include <QFile>
+#include <QVector>
+
+#include "Span.h"
+
+/**
+ * @brief A time series in the native binary format (.tsb), mapped into memory.
+ *
+ * The file is little-endian and consists of
+ *  - @c header_t;
+ *  - @c header_t::nCoefficients doubles, the coefficients of the generator, if any;
+ *  - zero padding up to @c header_t::payloadOffset, a multiple of @c alignment;
+ *  - @c header_t::length values of the type @c header_t::dtype.
+ *
+ * Float32 payloads are used right from the mapping with no copies,
+ * float64 ones are converted to float once on opening.
+ */
+class SeriesFile {
+public:
+    static constexpr uint32_t currentVersion = 1;
+    /// The payload is aligned so that vector loads from the mapping never split cache lines
+    static constexpr int alignment = 64;
+
+    enum dtype_t : uint32_t {
+        float32 = 1,
+        float64 = 2
+    };
+
+    struct header_t {
+        /// @c "TSB" followed by the byte 0x1a, see @c isSeriesFile
+        char magic[4];
+        uint32_t version;
+        uint32_t dtype;
+        uint32_t nCoefficients;
+        uint64_t length;
+        /// Where the values start from the beginning of the file
+        uint64_t payloadOffset;
+    };
+
+    /// Map the file; check @c isValid() afterwards
+    explicit SeriesFile (const QString& fileName);
+    SeriesFile (const SeriesFile&) = delete;
+    SeriesFile& operator= (const SeriesFile&) = delete;
+
+    /// Whether the file is a readable series file of a known version
+    bool isValid () const noexcept { return _Valid; }
+
+    int size () const noexcept { return _Values.size(); }
+    Span <const float> values () const noexcept { return _Values; }
+    /// The coefficients of the generator the series was made with, empty if unknown
+    const QVector <double>& coefficients () const noexcept { return _Coefficients; }
+
+    /// Does the file start with the .tsb signature
+    static bool isSeriesFile (const QString& fileName);
+
+    /// Write the float32 series with the given generator coefficients
+    static bool write (const QString& fileName,
+                       Span <const float> values,
+                       const QVector <double>& coefficients = QVector <double> ());
+    /// Write the float64 series with the given generator coefficients
+    static bool write (const QString& fileName,
+                       Span <const double> values,
+                       const QVector <double>& coefficients = QVector <double> ());
+
+private:
+    QFile _File;
+    bool _Valid = false;
+    Span <const float> _Values;
+    /// The values of a float64 payload narrowed to float
+    QVector <float> _Converted;
+    QVector <double> _Coefficients;
+};
+
+#endif // SERIESFILE_H
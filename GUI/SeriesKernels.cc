@@ -0,0 +1,342 @@
+#include "SeriesKernels.h"
+
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#if defined (__GNUC__) and (defined (__x86_64__) or defined (__i386__))
+#include <immintrin.h>
+#endif
+
+void minMaxSum(const float* v, int n, float& min, float& max, double& sum) {
+    int i = 0;
+    float lo = v[0], hi = v[0];
+    double s = 0.;
+
+#ifdef __SSE2__
+    if (n >= 4) {
+        __m128 vlo = _mm_loadu_ps(v),
+               vhi = vlo;
+        // two double accumulators for the lower and the upper pairs of floats
+        __m128d s0 = _mm_setzero_pd(),
+                s1 = _mm_setzero_pd();
+        for (; i + 4 <= n; i += 4) {
+            const __m128 x = _mm_loadu_ps(v + i);
+            vlo = _mm_min_ps(vlo, x);
+            vhi = _mm_max_ps(vhi, x);
+            s0 = _mm_add_pd(s0, _mm_cvtps_pd(x));
+            s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+        }
+
+        alignas (16) float l[4], h[4];
+        alignas (16) double p[2];
+        _mm_store_ps(l, vlo);
+        _mm_store_ps(h, vhi);
+        _mm_store_pd(p, _mm_add_pd(s0, s1));
+        for (int j = 0; j < 4; ++j) {
+            lo = l[j] < lo ? l[j] : lo;
+            hi = h[j] > hi ? h[j] : hi;
+        }
+        s = p[0] + p[1];
+    }
+#endif
+
+    for (; i < n; ++i) {
+        lo = v[i] < lo ? v[i] : lo;
+        hi = v[i] > hi ? v[i] : hi;
+        s += v[i];
+    }
+
+    min = lo;
+    max = hi;
+    sum = s;
+}
+
+namespace {
+template <typename code_t>
+void quantizeScalar(const float* v, int n, float inf, float step, unsigned top, code_t* codes) {
+    for (int i = 0; i < n; ++i) {
+        unsigned c = (v[i] - inf) / step;
+        codes[i] = c > top ? top : c;
+    }
+}
+
+#if defined (__GNUC__) and (defined (__x86_64__) or defined (__i386__))
+#define HAVE_AVX2_DISPATCH
+
+bool hasAvx2() {
+    static const bool ans = __builtin_cpu_supports("avx2");
+    return ans;
+}
+
+__attribute__ ((target ("avx2")))
+inline __m256i quantize8(const float* v, __m256 inf, __m256 step, __m256i top) {
+    const __m256 q = _mm256_div_ps(_mm256_sub_ps(_mm256_loadu_ps(v), inf), step);
+    return _mm256_min_epu32(_mm256_cvttps_epi32(q), top);
+}
+
+template <typename code_t>
+__attribute__ ((target ("avx2")))
+void quantizeAvx2(const float* v, int n, float inf, float step, unsigned top, code_t* codes) {
+    const __m256 vinf = _mm256_set1_ps(inf),
+                 vstep = _mm256_set1_ps(step);
+    const __m256i vtop = _mm256_set1_epi32(top);
+    int i = 0;
+    if (sizeof (code_t) == 1) {
+        // packing works within 128-bit lanes, the permutation restores the order
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        for (; i + 32 <= n; i += 32) {
+            const __m256i a = quantize8(v + i, vinf, vstep, vtop),
+                          b = quantize8(v + i + 8, vinf, vstep, vtop),
+                          c = quantize8(v + i + 16, vinf, vstep, vtop),
+                          d = quantize8(v + i + 24, vinf, vstep, vtop);
+            const __m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(a, b),
+                                                      _mm256_packs_epi32(c, d));
+            _mm256_storeu_si256(reinterpret_cast <__m256i*> (codes + i),
+                                _mm256_permutevar8x32_epi32(bytes, order));
+        }
+    } else if (sizeof (code_t) == 2) {
+        for (; i + 16 <= n; i += 16) {
+            const __m256i a = quantize8(v + i, vinf, vstep, vtop),
+                          b = quantize8(v + i + 8, vinf, vstep, vtop);
+            _mm256_storeu_si256(reinterpret_cast <__m256i*> (codes + i),
+                                _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8));
+        }
+    } else {
+        for (; i + 8 <= n; i += 8)
+            _mm256_storeu_si256(reinterpret_cast <__m256i*> (codes + i),
+                                quantize8(v + i, vinf, vstep, vtop));
+    }
+    quantizeScalar (v + i, n - i, inf, step, top, codes + i);
+}
+#endif
+
+#ifdef __SSE2__
+inline __m128i quantize4(const float* v, __m128 inf, __m128 step, __m128i top) {
+    const __m128i q = _mm_cvttps_epi32(_mm_div_ps(_mm_sub_ps(_mm_loadu_ps(v), inf), step));
+    // SSE2 has no unsigned minimum, but the codes are far below 2^31
+    const __m128i greater = _mm_cmpgt_epi32(q, top);
+    return _mm_or_si128(_mm_and_si128(greater, top), _mm_andnot_si128(greater, q));
+}
+
+template <typename code_t>
+void quantizeSse2(const float* v, int n, float inf, float step, unsigned top, code_t* codes) {
+    const __m128 vinf = _mm_set1_ps(inf),
+                 vstep = _mm_set1_ps(step);
+    const __m128i vtop = _mm_set1_epi32(top);
+    int i = 0;
+    if (sizeof (code_t) == 1) {
+        for (; i + 16 <= n; i += 16) {
+            const __m128i a = quantize4(v + i, vinf, vstep, vtop),
+                          b = quantize4(v + i + 4, vinf, vstep, vtop),
+                          c = quantize4(v + i + 8, vinf, vstep, vtop),
+                          d = quantize4(v + i + 12, vinf, vstep, vtop);
+            _mm_storeu_si128(reinterpret_cast <__m128i*> (codes + i),
+                             _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+        }
+    } else if (sizeof (code_t) == 2) {
+        // SSE2 packs with signed saturation only: shift the codes into the signed range and back
+        const __m128i bias32 = _mm_set1_epi32(0x8000),
+                      bias16 = _mm_set1_epi16(static_cast <short> (0x8000));
+        for (; i + 8 <= n; i += 8) {
+            const __m128i a = _mm_sub_epi32(quantize4(v + i, vinf, vstep, vtop), bias32),
+                          b = _mm_sub_epi32(quantize4(v + i + 4, vinf, vstep, vtop), bias32);
+            _mm_storeu_si128(reinterpret_cast <__m128i*> (codes + i),
+                             _mm_xor_si128(_mm_packs_epi32(a, b), bias16));
+        }
+    } else if (top <= 0x7FFFFFFFu) {
+        for (; i + 4 <= n; i += 4)
+            _mm_storeu_si128(reinterpret_cast <__m128i*> (codes + i),
+                             quantize4(v + i, vinf, vstep, vtop));
+    }
+    quantizeScalar (v + i, n - i, inf, step, top, codes + i);
+}
+#endif
+
+template <typename code_t>
+void quantizeAny(const float* v, int n, float inf, float step, unsigned top, code_t* codes) {
+#ifdef HAVE_AVX2_DISPATCH
+    if (hasAvx2())
+        return quantizeAvx2(v, n, inf, step, top, codes);
+#endif
+#ifdef __SSE2__
+    quantizeSse2(v, n, inf, step, top, codes);
+#else
+    quantizeScalar(v, n, inf, step, top, codes);
+#endif
+}
+}
+
+void quantize(const float* v, int n, float inf, float step, unsigned top, uint8_t* codes) {
+    quantizeAny(v, n, inf, step, top, codes);
+}
+
+void quantize(const float* v, int n, float inf, float step, unsigned top, uint16_t* codes) {
+    quantizeAny(v, n, inf, step, top, codes);
+}
+
+void quantize(const float* v, int n, float inf, float step, unsigned top, uint32_t* codes) {
+    quantizeAny(v, n, inf, step, top, codes);
+}
+
+namespace {
+/// @c minMaxSumLanes of the lanes [begin; end) one by one
+void minMaxSumScalar(const float* rows, int n, int nLanes, int begin, int end,
+                     float* min, float* max, double* sum) {
+    for (int s = begin; s < end; ++s) {
+        float lo = rows[s], hi = rows[s];
+        double a[4] = {0., 0., 0., 0.}, t = 0.;
+        int i = 0;
+#ifdef __SSE2__
+        // the vector of minMaxSum adds the values i with the same i % 4 together,
+        // then the classes as (0 + 2) + (1 + 3)
+        if (n >= 4) {
+            for (; i + 4 <= n; i += 4)
+                for (int r = 0; r < 4; ++r) {
+                    const float v = rows[(i + r) * nLanes + s];
+                    lo = v < lo ? v : lo;
+                    hi = v > hi ? v : hi;
+                    a[r] += v;
+                }
+            t = (a[0] + a[2]) + (a[1] + a[3]);
+        }
+#endif
+        for (; i < n; ++i) {
+            const float v = rows[i * nLanes + s];
+            lo = v < lo ? v : lo;
+            hi = v > hi ? v : hi;
+            t += v;
+        }
+        min[s] = lo;
+        max[s] = hi;
+        sum[s] = t;
+    }
+}
+
+/// @c encodeLanes of the lanes [begin; end) one by one, the loop of TimeSeries' encode
+void encodeScalar(const float* rows, int n, int nLanes, int begin, int end,
+                  const float* inf, const float* step, unsigned top, const double* mean,
+                  uint8_t* codes, float* tendency, double* variance, double* range) {
+    for (int s = begin; s < end; ++s) {
+        const double MX = mean[s];
+        double EX = 0., S = 0.;
+        double Wmax = rows[s] - MX,
+               Wmin = Wmax;
+        for (int i = 0; i < n; ++i) {
+            const int at = i * nLanes + s;
+            const float value = rows[at];
+            const unsigned c = (value - inf[s]) / step[s];
+            codes[at] = c > top ? top : c;
+            EX += value;
+            const double W = EX - (i + 1) * MX;
+            Wmax = W > Wmax ? W : Wmax;
+            Wmin = W < Wmin ? W : Wmin;
+            S += (value - MX) * (value - MX);
+
+            tendency[at] = i == 0 ? 0.f
+                                  : static_cast <float> (codes[at] > codes[at - nLanes])
+                                  - static_cast <float> (codes[at] < codes[at - nLanes]);
+        }
+        variance[s] = S / n;
+        range[s] = Wmax - Wmin;
+    }
+}
+}
+
+void minMaxSumLanes(const float* rows, int n, int nLanes, float* min, float* max, double* sum) {
+    int s = 0;
+#ifdef __SSE2__
+    // four series at a time, a series per float and two doubles per register, as minMaxSum
+    // has four values of a series at a time; the sums go by i % 4 all the same
+    if (n >= 4) {
+        for (; s + 4 <= nLanes; s += 4) {
+            __m128 vlo = _mm_loadu_ps(rows + s),
+                   vhi = vlo;
+            __m128d lower[4], upper[4];
+            for (int r = 0; r < 4; ++r)
+                lower[r] = upper[r] = _mm_setzero_pd();
+            int i = 0;
+            for (; i + 4 <= n; i += 4)
+                for (int r = 0; r < 4; ++r) {
+                    const __m128 x = _mm_loadu_ps(rows + (i + r) * nLanes + s);
+                    vlo = _mm_min_ps(vlo, x);
+                    vhi = _mm_max_ps(vhi, x);
+                    lower[r] = _mm_add_pd(lower[r], _mm_cvtps_pd(x));
+                    upper[r] = _mm_add_pd(upper[r], _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+                }
+            __m128d s0 = _mm_add_pd(_mm_add_pd(lower[0], lower[2]), _mm_add_pd(lower[1], lower[3])),
+                    s1 = _mm_add_pd(_mm_add_pd(upper[0], upper[2]), _mm_add_pd(upper[1], upper[3]));
+            for (; i < n; ++i) {
+                const __m128 x = _mm_loadu_ps(rows + i * nLanes + s);
+                vlo = _mm_min_ps(vlo, x);
+                vhi = _mm_max_ps(vhi, x);
+                s0 = _mm_add_pd(s0, _mm_cvtps_pd(x));
+                s1 = _mm_add_pd(s1, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+            }
+            _mm_storeu_ps(min + s, vlo);
+            _mm_storeu_ps(max + s, vhi);
+            _mm_storeu_pd(sum + s, s0);
+            _mm_storeu_pd(sum + s + 2, s1);
+        }
+    }
+#endif
+    minMaxSumScalar (rows, n, nLanes, s, nLanes, min, max, sum);
+}
+
+void encodeLanes(const float* rows, int n, int nLanes, const float* inf, const float* step,
+                 unsigned top, const double* mean,
+                 uint8_t* codes, float* tendency, double* variance, double* range) {
+    int s = 0;
+#ifdef __SSE2__
+    const __m128i vtop = _mm_set1_epi32(top);
+    for (; s + 4 <= nLanes; s += 4) {
+        const __m128 vinf = _mm_loadu_ps(inf + s),
+                     vstep = _mm_loadu_ps(step + s);
+        // the lower and the upper pair of the series in double precision
+        const __m128d MX0 = _mm_loadu_pd(mean + s),
+                      MX1 = _mm_loadu_pd(mean + s + 2);
+        __m128d EX0 = _mm_setzero_pd(), EX1 = EX0,
+                S0 = EX0, S1 = EX0;
+        const __m128 first = _mm_loadu_ps(rows + s);
+        __m128d Wmax0 = _mm_sub_pd(_mm_cvtps_pd(first), MX0),
+                Wmax1 = _mm_sub_pd(_mm_cvtps_pd(_mm_movehl_ps(first, first)), MX1),
+                Wmin0 = Wmax0, Wmin1 = Wmax1;
+        __m128i previous = _mm_setzero_si128();
+        for (int i = 0; i < n; ++i) {
+            const int at = i * nLanes + s;
+            const __m128 x = _mm_loadu_ps(rows + at);
+            const __m128i c = quantize4(rows + at, vinf, vstep, vtop);
+            const int packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packs_epi32(c, c), c));
+            std::memcpy (codes + at, &packed, 4);
+            // (c > previous) - (c < previous), the masks being -1
+            const __m128i t = _mm_sub_epi32(_mm_cmplt_epi32(c, previous), _mm_cmpgt_epi32(c, previous));
+            _mm_storeu_ps(tendency + at, i == 0 ? _mm_setzero_ps() : _mm_cvtepi32_ps(t));
+            previous = c;
+
+            const __m128d x0 = _mm_cvtps_pd(x),
+                          x1 = _mm_cvtps_pd(_mm_movehl_ps(x, x)),
+                          k = _mm_set1_pd(i + 1);
+            EX0 = _mm_add_pd(EX0, x0);
+            EX1 = _mm_add_pd(EX1, x1);
+            const __m128d W0 = _mm_sub_pd(EX0, _mm_mul_pd(k, MX0)),
+                          W1 = _mm_sub_pd(EX1, _mm_mul_pd(k, MX1));
+            // W > Wmax ? W : Wmax and the other way round, as the scalar code
+            Wmax0 = _mm_max_pd(W0, Wmax0);
+            Wmax1 = _mm_max_pd(W1, Wmax1);
+            Wmin0 = _mm_min_pd(W0, Wmin0);
+            Wmin1 = _mm_min_pd(W1, Wmin1);
+            const __m128d d0 = _mm_sub_pd(x0, MX0),
+                          d1 = _mm_sub_pd(x1, MX1);
+            S0 = _mm_add_pd(S0, _mm_mul_pd(d0, d0));
+            S1 = _mm_add_pd(S1, _mm_mul_pd(d1, d1));
+        }
+        const __m128d count = _mm_set1_pd(n);
+        _mm_storeu_pd(variance + s, _mm_div_pd(S0, count));
+        _mm_storeu_pd(variance + s + 2, _mm_div_pd(S1, count));
+        _mm_storeu_pd(range + s, _mm_sub_pd(Wmax0, Wmin0));
+        _mm_storeu_pd(range + s + 2, _mm_sub_pd(Wmax1, Wmin1));
+    }
+#endif
+    encodeScalar (rows, n, nLanes, s, nLanes, inf, step, top, mean, codes, tendency, variance, range);
+}
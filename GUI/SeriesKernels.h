@@ -0,0 +1,53 @@
+#ifndef SERIESKERNELS_H_ce85de91_ecef_48a1_ae79_45a89444d8aa
+#define SERIESKERNELS_H_ce85de91_ecef_48a1_ae79_45a89444d8aa
+
+#include <cstdint>
+
+/**
+ * @file Vectorized loops over the series values.
+ *
+ * SSE2 versions are used where the compiler targets it (always on x86-64),
+ * plain loops elsewhere. The quantizer also has an AVX2 version
+ * chosen at run time when built by GCC or Clang.
+ */
+
+/**
+ * @brief find the minimum, the maximum and the sum of @p n > 0 values in one pass.
+ *
+ * The sum is accumulated in double precision.
+ */
+void minMaxSum (const float* values, int n, float& min, float& max, double& sum);
+
+/**
+ * @brief replace each value with the number of its half-segment.
+ *
+ * codes[i] = min (unsigned ((values[i] - inf) / step), top);
+ * the division is exact as in the scalar code, so are the codes.
+ * @param step must be positive
+ */
+void quantize (const float* values, int n, float inf, float step, unsigned top, uint8_t* codes);
+void quantize (const float* values, int n, float inf, float step, unsigned top, uint16_t* codes);
+void quantize (const float* values, int n, float inf, float step, unsigned top, uint32_t* codes);
+
+/**
+ * @brief @c minMaxSum of @p nLanes interleaved series of @p n > 0 values,
+ *  the value i of the series s being at rows[i * nLanes + s].
+ *
+ * Each sum is accumulated in the same order as @c minMaxSum does, so it is the same to the bit.
+ */
+void minMaxSumLanes (const float* rows, int n, int nLanes, float* min, float* max, double* sum);
+
+/**
+ * @brief the second pass of the encoding of @p nLanes interleaved series, see @c minMaxSumLanes.
+ *
+ * For each series s with the limit inf[s], the step[s] > 0 of the codes and the mean[s]:
+ * codes as by @c quantize, the tendency of the codes, Σ (x - mean)² / n as variance[s]
+ * and max - min of the cumulative deviations from the mean as range[s],
+ * all of them the same to the bit as @c TimeSeries gets for the series alone.
+ * The codes and the tendency go in the same layout as the values.
+ */
+void encodeLanes (const float* rows, int n, int nLanes, const float* inf, const float* step,
+                  unsigned top, const double* mean,
+                  uint8_t* codes, float* tendency, double* variance, double* range);
+
+#endif // SERIESKERNELS_H
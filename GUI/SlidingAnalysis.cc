@@ -0,0 +1,217 @@
+#include "SlidingAnalysis.h"
+#include "Fourier.h"
+#include "WordStatistics.h"
+#include "Coordinates.h"
+
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+using complex = RealFFT::complex;
+
+/// The word lengths counted at first, doubled when a window needs longer words
+constexpr int initialWordLength = 8;
+
+/**
+ * @brief The metrics of one sequence, the series or its tendency, over the sliding window.
+ *
+ * The window only moves forward, @c moveTo updates whatever it can incrementally.
+ */
+class Channel {
+public:
+    Channel (const TimeSeries& series, int window)
+        : _Values (series.values()),
+          _Codes (series.encoded()),
+          _NLevels (series.nLevels()),
+          _Window (window),
+          _Period (window - 1),
+          _Engine (_Values.data(), _Values.size()),
+          _Plan (RealFFT::plan(_Period)),
+          _Spectrum (_Period / 2 + 1),
+          _Rotation (window / 2),
+          _Buffer (_Period),
+          _Amplitudes (window / 2) {
+        // sliding by one costs window/2 complex updates, an FFT about period·log2(period)
+        _MaxSlide = std::max (1, static_cast <int> (2 * log2 (_Period)));
+        for (size_t k = 0; k < _Rotation.size(); ++k)
+            _Rotation[k] = std::polar (1., 2 * M_PI * k / _Period);
+    }
+
+    void moveTo (int begin) {
+        const int shift = begin - _Begin;
+        if (_Begin >= 0 and shift <= _MaxSlide and _Slid + shift < _Period) {
+            for (int i = _Begin; i < begin; ++i)
+                _Slide (i);
+            _Slid += shift;
+        } else {
+            for (int j = 0; j < _Period; ++j)
+                _Buffer[j] = _Values[begin + j];
+            _Plan->transform(_Buffer.data(), _Spectrum.data());
+            _Slid = 0;
+        }
+
+        if (_Begin >= 0 and _Words.maxLength() > 0 and _WordsSlid + shift < _Window) {
+            for (int i = _Begin; i < begin; ++i) {
+                _Words.removeFirst();
+                _Words.append(_Codes[i + _Window]);
+            }
+            _WordsSlid += shift;
+        } else {
+            _Words.rebuild(_WindowCodes (begin), _NLevels,
+                           std::max (_Words.maxLength(), initialWordLength), _Window);
+            _WordsSlid = 0;
+        }
+        _Begin = begin;
+    }
+
+    /// see @c TimeSeries::harmonicComplexity
+    double harmonicComplexity () const {
+        // The spectrum is the one of the raw values [begin; begin + period), the trapezoid rule
+        // replaces the first one with the mean of the first and the last ones,
+        // and the window mean only affects the zero frequency.
+        const float avg = _Engine.mean(_Begin, _Begin + _Window);
+        const double edge = (_Values[_Begin + _Period] - _Values[_Begin]) / 2.;
+        std::vector <double>& R = _Amplitudes;
+        for (size_t k = 0; k < R.size(); ++k) {
+            const complex Y = _Spectrum[k] + edge - (k == 0 ? _Period * static_cast <double> (avg) : 0.);
+            R[k] = 2. / _Period * std::abs (Y);
+        }
+
+        std::sort (R.begin(), R.end(), [](double a, double b){return b < a;});
+        double sum = std::accumulate (R.begin(), R.end(), 0.);
+        double complexity = 0.;
+        for (size_t i = 1; i < R.size(); ++i)
+            complexity += R[i] / sum * i;
+        return complexity;
+    }
+
+    double herstValue (HurstEstimator method) const {
+        return _Engine.estimate(method, _Begin, _Begin + _Window);
+    }
+
+    /// see @c TimeSeries::lempelZivComplexity
+    double lempelZivComplexity () const {
+        return TimeSeries::lempelZivComplexity(_WindowCodes (_Begin), _NLevels);
+    }
+
+    /// see @c TimeSeries::symbolicDiversity
+    TimeSeries::symbolicDiversity_t symbolicDiversity () {
+        TimeSeries::symbolicDiversity_t ans;
+        while (not _Words.symbolicDiversity(ans.window, ans.maxdiff)) {
+            _Words.rebuild(_WindowCodes (_Begin), _NLevels, 2 * _Words.maxLength(), _Window);
+            _WordsSlid = 0;
+        }
+        return ans;
+    }
+
+private:
+    /// Slide the spectrum from the window starting at @p i to the one at i + 1
+    void _Slide (int i) {
+        const double delta = _Values[i + _Period] - _Values[i];
+        for (size_t k = 0; k < _Rotation.size(); ++k)
+            _Spectrum[k] = (_Spectrum[k] + delta) * _Rotation[k];
+    }
+
+    CodeSpan _WindowCodes (int begin) const {
+        return CodeSpan (static_cast <const char*> (_Codes.data()) + begin * _Codes.width(),
+                         _Window, _Codes.width());
+    }
+
+    Span <const float> _Values;
+    CodeSpan _Codes;
+    unsigned _NLevels;
+    int _Window;
+    /// the harmonic analysis works over window - 1 values, see @c TimeSeries::harmonicComplexity
+    int _Period;
+    HurstEngine _Engine;
+    std::shared_ptr <const RealFFT> _Plan;
+    /// Σ x_j exp(-2πi·jk/period) of the window values but the last one
+    std::vector <complex> _Spectrum;
+    /// exp(2πi·k/period) for the amplitudes in use, k < window / 2
+    std::vector <complex> _Rotation;
+    std::vector <double> _Buffer;
+    mutable std::vector <double> _Amplitudes;
+    /// The longest move done by sliding rather than by an FFT
+    int _MaxSlide;
+    /// How many slides since the last FFT: the rounding errors accumulate
+    int _Slid = 0;
+    WordStatistics _Words;
+    /**
+     * How many codes slid through the words since the last rebuild:
+     * the words that left the window keep their numbers with zero counts,
+     * so the counters are rebuilt once a whole window has passed.
+     */
+    int _WordsSlid = 0;
+    int _Begin = -1;
+};
+}
+
+SlidingAnalysis::SlidingAnalysis(const TimeSeries& series, int window, int hop,
+                                 HurstEstimator herstEstimator)
+    : _Series (series),
+      _Tendency (series.tendencySeries()),
+      _Window (window),
+      _Hop (std::max (1, hop)),
+      _HerstEstimator (herstEstimator) {
+}
+
+int SlidingAnalysis::nWindows() const {
+    if (_Window < 4 or _Series.size() < _Window)
+        return 0;
+    return (_Series.size() - _Window) / _Hop + 1;
+}
+
+QVector <coordinates_t> SlidingAnalysis::trajectory() const {
+    const int n = nWindows();
+    QVector <coordinates_t> ans (n);
+    if (n == 0)
+        return ans;
+
+    Channel series (_Series, _Window),
+            tendency (_Tendency, _Window);
+    for (int i = 0; i < n; ++i) {
+        series.moveTo(windowStart(i));
+        tendency.moveTo(windowStart(i));
+
+        auto& c = ans[i].by_name;
+        c.harmonicComplexity = series.harmonicComplexity();
+        c.tendencyHarmonicComplexity = tendency.harmonicComplexity();
+        c.fractalDimensionality = 2 - series.herstValue(_HerstEstimator);
+        c.tendencyFractalDimensionality = 2 - tendency.herstValue(_HerstEstimator);
+
+        const auto diversity = series.symbolicDiversity(),
+                   tendencyDiversity = tendency.symbolicDiversity();
+        c.symbolicDiversityWindow = diversity.window;
+        c.tendencySymbolicDiversityWindow = tendencyDiversity.window;
+        c.symbolicDiversityDiff = diversity.maxdiff;
+        c.tendencySymbolicDiversityDiff = tendencyDiversity.maxdiff;
+
+        c.KolmogorovComplexity = c.tendencyKolmogorovComplexity
+                               = std::numeric_limits <double>::quiet_NaN();
+        c.LempelZivComplexity = series.lempelZivComplexity();
+        c.tendencyLempelZivComplexity = tendency.lempelZivComplexity();
+    }
+    return ans;
+}
+
+bool SlidingAnalysis::write(const QString& fileName,
+                            const QVector <coordinates_t>& trajectory) const {
+    QFile file (fileName);
+    if (not file.open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Truncate))
+        return false;
+    QTextStream out (&file);
+    out << "# window " << _Window << " hop " << _Hop << "\n";
+    for (int i = 0; i < trajectory.size(); ++i) {
+        out << windowStart(i);
+        for (double v : trajectory[i].values)
+            out << "\t" << v;
+        out << "\n";
+    }
+    out.flush();
+    return out.status() == QTextStream::Ok;
+}
@@ -0,0 +1,60 @@
+#ifndef SLIDINGANALYSIS_H_7e2b94d1_c03a_4f6e_9d58_a41b6f2e8c37
+#define SLIDINGANALYSIS_H_7e2b94d1_c03a_4f6e_9d58_a41b6f2e8c37
+
+#include <QVector>
+
+#include "Hurst.h"
+#include "TimeSeries.h"
+
+struct coordinates_t;
+
+/**
+ * @brief Coordinates of the windows sliding along a series: how the metrics evolve.
+ *
+ * The window of @c window() values moves by @c hop() values.
+ * No window is analysed as a fresh series:
+ *  - the window means, variances and Hurst exponents come from the prefix sums
+ *    of the whole series shared by all the windows, see @c HurstEngine;
+ *  - the harmonic amplitudes are updated by the sliding DFT while the hop is short
+ *    compared to the cost of an FFT of the window, otherwise each window gets its own FFT;
+ *  - the words are counted by adding the codes entering the window and removing
+ *    the ones leaving it, see @c WordStatistics.
+ *
+ * The codes are the ones of the whole series, so the symbolic metrics of all the windows
+ * are on the same scale; the same goes for the tendency series.
+ * Kolmogorov complexity is not estimated per window and is NaN,
+ * the Lempel–Ziv one takes its place.
+ */
+class SlidingAnalysis {
+public:
+    SlidingAnalysis (const TimeSeries& series, int window, int hop,
+                     HurstEstimator herstEstimator = HurstEstimator::wholeSeries);
+
+    int window () const noexcept { return _Window; }
+    int hop () const noexcept { return _Hop; }
+    /// How many windows fit into the series
+    int nWindows () const;
+    /// Where the window number @p i starts
+    int windowStart (int i) const { return i * _Hop; }
+
+    /// The coordinates of all the windows in their order
+    QVector <coordinates_t> trajectory () const;
+
+    /**
+     * @brief write the @p trajectory as text.
+     *
+     * The first line is a comment with the window and the hop,
+     * then each line is the window start followed by its coordinates, separated by tabs.
+     * @return false if the file could not be written in full
+     */
+    bool write (const QString& fileName, const QVector <coordinates_t>& trajectory) const;
+
+private:
+    TimeSeries _Series;
+    TimeSeries _Tendency;
+    int _Window;
+    int _Hop;
+    HurstEstimator _HerstEstimator;
+};
+
+#endif // SLIDINGANALYSIS_H
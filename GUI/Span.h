@@ -0,0 +1,71 @@
+#ifndef SPAN_H_edf89c2b_bc01_4652_8edc_0b8ccf3ef469
+#define SPAN_H_edf89c2b_bc01_4652_8edc_0b8ccf3ef469
+
+#include <cstdint>
+
+/// A non-owning view of @c size() consecutive values
+template <typename T>
+class Span {
+public:
+    Span () = default;
+    Span (T* data, int size) : _Data (data), _Size (size) {}
+
+    T* data () const noexcept { return _Data; }
+    int size () const noexcept { return _Size; }
+    bool isEmpty () const noexcept { return _Size == 0; }
+
+    T& operator[] (int index) const { return _Data[index]; }
+    T* begin () const noexcept { return _Data; }
+    T* end () const noexcept { return _Data + _Size; }
+
+private:
+    T* _Data = nullptr;
+    int _Size = 0;
+};
+
+/**
+ * @brief A non-owning view of an encoded series.
+ *
+ * Each code takes as few bytes as its number of levels allows:
+ * 1 byte for up to 256 levels, 2 bytes for up to 65536, 4 bytes otherwise.
+ * Element access is generic but slow, tight loops should go through @c visit.
+ */
+class CodeSpan {
+public:
+    /// How many bytes a code takes for the given number of levels
+    static unsigned widthFor (unsigned nLevels) noexcept {
+        return nLevels <= 0x100u ? 1 : nLevels <= 0x10000u ? 2 : 4;
+    }
+
+    CodeSpan () = default;
+    CodeSpan (const void* data, int size, unsigned width)
+        : _Data (data), _Size (size), _Width (width) {}
+
+    int size () const noexcept { return _Size; }
+    bool isEmpty () const noexcept { return _Size == 0; }
+    /// Bytes per code
+    unsigned width () const noexcept { return _Width; }
+    const void* data () const noexcept { return _Data; }
+    int byteSize () const noexcept { return _Size * _Width; }
+
+    unsigned operator[] (int index) const {
+        return visit([index](const auto* codes) -> unsigned { return codes[index]; });
+    }
+
+    /// Call @p f with the pointer to the codes of their actual type
+    template <typename F>
+    auto visit (F&& f) const -> decltype (f (static_cast <const uint8_t*> (nullptr))) {
+        switch (_Width) {
+        case 1:  return f (static_cast <const uint8_t*> (_Data));
+        case 2:  return f (static_cast <const uint16_t*> (_Data));
+        default: return f (static_cast <const uint32_t*> (_Data));
+        }
+    }
+
+private:
+    const void* _Data = nullptr;
+    int _Size = 0;
+    unsigned _Width = 1;
+};
+
+#endif // SPAN_H
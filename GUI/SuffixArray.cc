@@ -0,0 +1,114 @@
+#include "SuffixArray.h"
+
+#include <algorithm>
+
+SuffixArray::SuffixArray(const CodeSpan& text, unsigned alphabet)
+    : _Suffixes (text.size()), _Lcp (text.size(), 0) {
+    if (text.isEmpty())
+        return;
+    text.visit([this, &text, alphabet](const auto* codes){
+        _Build (codes, text.size(), alphabet);
+    });
+}
+
+template <typename code_t>
+void SuffixArray::_Build(const code_t* text, int n, unsigned alphabet) {
+    QVector <int>& sa = _Suffixes;
+    QVector <int> rank (n), tmp (n);
+    QVector <int> count (std::max (static_cast <int> (alphabet), n) + 1);
+
+    // sort the suffixes by their first symbols
+    for (int i = 0; i < n; ++i)
+        ++count[text[i]];
+    for (int c = 1; c < count.size(); ++c)
+        count[c] += count[c - 1];
+    for (int i = n - 1; i >= 0; --i)
+        sa[--count[text[i]]] = i;
+
+    int nClasses = 1;
+    rank[sa[0]] = 0;
+    for (int i = 1; i < n; ++i) {
+        if (text[sa[i]] != text[sa[i - 1]])
+            ++nClasses;
+        rank[sa[i]] = nClasses - 1;
+    }
+
+    // sort by the first 2k symbols knowing the order by the first k ones
+    for (int k = 1; nClasses < n; k <<= 1) {
+        // order by the second half: the suffixes shorter than k go first
+        int p = 0;
+        for (int i = n - k; i < n; ++i)
+            tmp[p++] = i;
+        for (int i = 0; i < n; ++i)
+            if (sa[i] >= k)
+                tmp[p++] = sa[i] - k;
+
+        // stable sort by the first half
+        std::fill (count.begin(), count.begin() + nClasses + 1, 0);
+        for (int i = 0; i < n; ++i)
+            ++count[rank[i]];
+        for (int c = 1; c < nClasses; ++c)
+            count[c] += count[c - 1];
+        for (int i = n - 1; i >= 0; --i)
+            sa[--count[rank[tmp[i]]]] = tmp[i];
+
+        auto second = [&rank, n, k](int i) {
+            return i + k < n ? rank[i + k] : -1;
+        };
+        tmp[sa[0]] = 0;
+        nClasses = 1;
+        for (int i = 1; i < n; ++i) {
+            if (rank[sa[i]] != rank[sa[i - 1]] or second (sa[i]) != second (sa[i - 1]))
+                ++nClasses;
+            tmp[sa[i]] = nClasses - 1;
+        }
+        std::swap (rank, tmp);
+    }
+
+    // Kasai: the prefix shared with the previous suffix
+    // shrinks by at most one when the suffix is shortened by one
+    for (int i = 0; i < n; ++i)
+        rank[sa[i]] = i;
+    int h = 0;
+    for (int i = 0; i < n; ++i) {
+        if (rank[i] == 0) {
+            h = 0;
+            continue;
+        }
+        const int j = sa[rank[i] - 1];
+        while (i + h < n and j + h < n and text[i + h] == text[j + h])
+            ++h;
+        _Lcp[rank[i]] = h;
+        if (h > 0)
+            --h;
+    }
+}
+
+QVector <int> SuffixArray::longestPreviousFactors() const {
+    const int n = size();
+    const QVector <int>& sa = _Suffixes;
+    QVector <int> lpf (n, 0);
+
+    // The best previous factor of a suffix is shared with the nearest suffix
+    // before or after it in the array that starts earlier in the text.
+    // The stack keeps the suffixes starting ever later in the text,
+    // each with its lcp with the one below.
+    struct entry_t {
+        int rank, lcp;
+    };
+    QVector <entry_t> stack;
+    stack.reserve(n);
+    for (int r = 0; r <= n; ++r) {
+        // the lcp of the top of the stack with the suffix r
+        int h = r < n ? _Lcp[r] : 0;
+        while (not stack.isEmpty() and (r == n or sa[stack.last().rank] > sa[r])) {
+            const entry_t top = stack.last();
+            stack.removeLast();
+            lpf[sa[top.rank]] = std::max (top.lcp, h);
+            h = std::min (h, top.lcp);
+        }
+        if (r < n)
+            stack.append(entry_t {r, stack.isEmpty() ? 0 : h});
+    }
+    return lpf;
+}
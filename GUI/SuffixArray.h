@@ -0,0 +1,50 @@
+#ifndef SUFFIXARRAY_H_8b23b5fb_a19a_4e94_8475_b83ebfe62d10
+#define SUFFIXARRAY_H_8b23b5fb_a19a_4e94_8475_b83ebfe62d10
+
+#include <QVector>
+
+#include "Span.h"
+
+/**
+ * @brief The suffix array of a sequence of codes along with the longest common prefixes
+ *  of the neighbouring suffixes.
+ *
+ * The array is built by prefix doubling with radix sorts, O(n log n);
+ * the prefixes are found by the Kasai algorithm, O(n).
+ */
+class SuffixArray {
+public:
+    /// @param text the sequence, each code must be less than @p alphabet
+    SuffixArray (const CodeSpan& text, unsigned alphabet);
+
+    int size () const noexcept { return _Suffixes.size(); }
+
+    /// Starting positions of the suffixes in the lexicographical order
+    const QVector <int>& suffixes () const noexcept {
+        return _Suffixes;
+    }
+    /**
+     * @brief lcp()[i] is the length of the longest common prefix
+     *  of the suffixes number i - 1 and i; lcp()[0] is 0.
+     */
+    const QVector <int>& lcp () const noexcept {
+        return _Lcp;
+    }
+
+    /**
+     * @brief the longest previous factors, O(n).
+     *
+     * The i-th one is the length of the longest prefix of the suffix i
+     * that also starts at some position j < i, maybe overlapping it.
+     */
+    QVector <int> longestPreviousFactors () const;
+
+private:
+    template <typename code_t>
+    void _Build (const code_t* text, int n, unsigned alphabet);
+
+    QVector <int> _Suffixes;
+    QVector <int> _Lcp;
+};
+
+#endif // SUFFIXARRAY_H
@@ -0,0 +1,125 @@
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+/// How many tasks each worker gets at first, enough to even out the costs guessed wrong
+constexpr int tasksPerWorker = 16;
+
+thread_local int currentWorker = -1;
+}
+
+TaskPool::TaskPool(const QVector <qint64>& costs, task_t task, int nWorkers,
+                   const volatile std::atomic <bool>* stop)
+    : _Costs (costs),
+      _Task (std::move (task)),
+      _Stop (stop) {
+    nWorkers = std::max (1, nWorkers);
+    const int n = costs.size();
+    for (qint64 c : costs)
+        _TotalCost += std::max <qint64> (c, 1);
+
+    // batch the consecutive items up to the grain
+    const qint64 grain = std::max <qint64> (1, _TotalCost / (nWorkers * tasksPerWorker));
+    std::vector <range_t> tasks;
+    for (int begin = 0; begin < n;) {
+        int end = begin;
+        qint64 cost = 0;
+        while (end < n and cost < grain)
+            cost += std::max <qint64> (costs[end++], 1);
+        tasks.push_back(range_t {begin, end});
+        begin = end;
+    }
+
+    // deal the tasks in blocks of about equal costs
+    for (int id = 0; id < nWorkers; ++id)
+        _Workers.emplace_back(new worker_t);
+    qint64 dealt = 0;
+    for (const range_t& t : tasks) {
+        const int id = std::min <qint64> (nWorkers - 1, dealt * nWorkers / _TotalCost);
+        _Workers[id]->tasks.push_back(t);
+        for (int i = t.begin; i < t.end; ++i)
+            dealt += std::max <qint64> (costs[i], 1);
+    }
+
+    _Running = nWorkers;
+    for (int id = 0; id < nWorkers; ++id)
+        _Threads.emplace_back(&TaskPool::_Work, this, id);
+}
+
+TaskPool::~TaskPool() {
+    for (std::thread& t : _Threads)
+        t.join();
+}
+
+bool TaskPool::wait(int milliseconds) {
+    std::unique_lock <std::mutex> lock (_FinishedMutex);
+    return _FinishedCondition.wait_for(lock, std::chrono::milliseconds (milliseconds),
+                                       [this]{ return _Running == 0; });
+}
+
+int TaskPool::workerId() noexcept {
+    return currentWorker;
+}
+
+void TaskPool::_Work(int id) {
+    currentWorker = id;
+    int i;
+    while (_Pop (id, i) or (_Steal (id) and _Pop (id, i))) {
+        _Task (i);
+        _DoneCost += std::max <qint64> (_Costs[i], 1);
+        ++_Done;
+    }
+    currentWorker = -1;
+
+    std::lock_guard <std::mutex> lock (_FinishedMutex);
+    if (--_Running == 0)
+        _FinishedCondition.notify_all();
+}
+
+bool TaskPool::_Pop(int id, int& item) {
+    if (_Stop and *_Stop)
+        return false;
+    worker_t& self = *_Workers[id];
+    std::lock_guard <std::mutex> lock (self.mutex);
+    if (self.tasks.empty())
+        return false;
+    // one item at a time, the rest of the task may still be stolen
+    range_t& task = self.tasks.back();
+    item = task.begin++;
+    if (task.begin == task.end)
+        self.tasks.pop_back();
+    return true;
+}
+
+bool TaskPool::_Steal(int id) {
+    const int nWorkers = _Workers.size();
+    // the tasks are never added but by moving the queued ones,
+    // so a worker that finds nothing to steal in one round has nothing more to do
+    for (int k = 1; k < nWorkers; ++k) {
+        if (_Stop and *_Stop)
+            return false;
+        range_t range;
+        {
+            worker_t& victim = *_Workers[(id + k) % nWorkers];
+            std::lock_guard <std::mutex> lock (victim.mutex);
+            if (victim.tasks.empty())
+                continue;
+            range = victim.tasks.front();
+            if (victim.tasks.size() == 1 and range.end - range.begin > 1) {
+                // the last task of the victim: leave it the first half
+                const int middle = range.begin + (range.end - range.begin) / 2;
+                victim.tasks.front().end = middle;
+                range.begin = middle;
+            } else {
+                victim.tasks.pop_front();
+            }
+        }
+        worker_t& self = *_Workers[id];
+        std::lock_guard <std::mutex> lock (self.mutex);
+        self.tasks.push_back(range);
+        return true;
+    }
+    return false;
+}
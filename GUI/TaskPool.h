@@ -0,0 +1,91 @@
+#ifndef TASKPOOL_H_4b8e2d61_f0a3_47c5_9e12_85d7c3b6a0f9
+#define TASKPOOL_H_4b8e2d61_f0a3_47c5_9e12_85d7c3b6a0f9
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QVector>
+
+/**
+ * @brief A work-stealing pool processing the items 0..n-1 in the background.
+ *
+ * The items are batched into tasks of consecutive items by their costs,
+ * so that the tiny ones go by hundreds and a huge one is a task alone,
+ * and the tasks are dealt to the workers in contiguous blocks of equal costs.
+ * Each worker takes the items one by one from the task at the back of its own deque;
+ * once it is empty, the worker steals the task from the front of another deque or,
+ * if that one is the last, the second half of its items. So the workers keep busy
+ * until the very end whatever the costs turn out to be.
+ *
+ * The calling thread takes no part: it may watch the progress, see @c wait.
+ */
+class TaskPool {
+public:
+    using task_t = std::function <void (int)>;
+
+    /**
+     * @brief start processing
+     * @param costs how much work each item is expected to take, e.g. the file sizes
+     * @param task what to do with the item number i, called from the workers
+     * @param nWorkers how many threads to run
+     * @param stop the items not started yet are skipped once it is set
+     */
+    TaskPool (const QVector <qint64>& costs, task_t task, int nWorkers,
+              const volatile std::atomic <bool>* stop = nullptr);
+    /// Waits for all the workers
+    ~TaskPool ();
+    TaskPool (const TaskPool&) = delete;
+    TaskPool& operator= (const TaskPool&) = delete;
+
+    /// Wait up to @p milliseconds, return whether all the workers have finished
+    bool wait (int milliseconds);
+
+    int nWorkers () const noexcept { return _Workers.size(); }
+    /// The number of the worker calling it, 0 ≤ id < nWorkers, or -1 outside the workers of any pool
+    static int workerId () noexcept;
+
+    /// How many items have been processed
+    int done () const noexcept { return _Done; }
+    /// The total cost of the processed items
+    qint64 doneCost () const noexcept { return _DoneCost; }
+    qint64 totalCost () const noexcept { return _TotalCost; }
+
+private:
+    /// The items [begin; end)
+    struct range_t {
+        int begin, end;
+    };
+    struct worker_t {
+        std::mutex mutex;
+        std::deque <range_t> tasks;
+    };
+
+    void _Work (int id);
+    /// Take the next item of the last task in the worker's own deque
+    bool _Pop (int id, int& item);
+    /// Move a task, or half of one, from some other worker to this one
+    bool _Steal (int id);
+
+    const QVector <qint64> _Costs;
+    const task_t _Task;
+    const volatile std::atomic <bool>* const _Stop;
+    qint64 _TotalCost = 0;
+
+    std::vector <std::unique_ptr <worker_t>> _Workers;
+    std::vector <std::thread> _Threads;
+
+    std::atomic <int> _Done {0};
+    std::atomic <qint64> _DoneCost {0};
+
+    std::mutex _FinishedMutex;
+    std::condition_variable _FinishedCondition;
+    int _Running = 0;
+};
+
+#endif // TASKPOOL_H
@@ -1,7 +1,11 @@
 #include "TimeSeries.h"
+#include "Fourier.h"
+#include "NumberParser.h"
+#include "SeriesKernels.h"
+#include "SuffixArray.h"
+#include "WordCounter.h"
 #include <algorithm>
 #include <QFile>
-#include <QTextStream>
 #include <QDebug>
 
 #include <cmath>
@@ -9,71 +13,75 @@
 
 using std::fabs;
 
-constexpr double M_2PI = 2 * M_PI;
-
 TimeSeries::TimeSeries(QVector<float> values) : _Values (values) {
 }
 
 void TimeSeries::readFile(const QString &fileName) {
-    QFile file (fileName);
-    file.open(QIODevice::ReadOnly);
-    QTextStream in (&file);
     _Values.clear();
-    while (not in.atEnd()) {
-        QString ln = in.readLine();
-        bool ok;
-        float f = ln.toFloat(&ok);
-        if (ok)
-            _Values.append(f);
-    }
+    _File.reset();
     dirty = true;
+    if (SeriesFile::isSeriesFile(fileName)) {
+        auto file = std::make_shared <const SeriesFile> (fileName);
+        if (file->isValid())
+            _File = std::move (file);
+        return;
+    }
+
+    QFile file (fileName);
+    if (not file.open(QIODevice::ReadOnly))
+        return;
+    const qint64 size = file.size();
+    if (uchar* data = size > 0 ? file.map(0, size) : nullptr) {
+        _Values = parseFloatLines (reinterpret_cast <const char*> (data), size);
+        file.unmap(data);
+    } else {
+        // pipes and other files that cannot be mapped
+        const QByteArray contents = file.readAll();
+        _Values = parseFloatLines (contents.constData(), contents.size());
+    }
+}
+
+CodeSpan TimeSeries::encoded() const {
+    if (dirty)
+        _Encode();
+    return CodeSpan (_Codes.constData(), size(), _CodeWidth);
 }
 
-const QVector<unsigned> &TimeSeries::encoded() const {
+const TimeSeries::statistics_t& TimeSeries::statistics() const {
     if (dirty)
         _Encode();
-    return _Encoded;
+    return _Statistics;
 }
 
 TimeSeries::limits TimeSeries::getLimits() const {
-    limits ans;
-    ans.inf = ans.sup = _Values[0];
-    for (int i = 1; i < _Values.size(); ++i) {
-        if (ans.inf > _Values[i])
-            ans.inf = _Values[i];
-        else if (ans.sup < _Values[i])
-            ans.sup = _Values [i];
-    }
-    return ans;
+    const auto& stats = statistics();
+    return limits {stats.inf, stats.sup};
 }
 
 void TimeSeries::removeTrend() {
-    const int size = _Values.size();
-    float avg = std::accumulate (_Values.begin(),
-                                 _Values.end(),
-                                 0.f,
-                                [size](float sum, float b)
-                                { return sum + b / size; });
+    const float avg = statistics().mean;
+    _Detach ();
     for (auto& v : _Values)
         v -= avg;
+    dirty = true;
+}
+
+void TimeSeries::_Detach() {
+    if (not _File)
+        return;
+    // the mapping is read-only
+    const auto mapped = _File->values();
+    _Values.resize(mapped.size());
+    std::copy (mapped.begin(), mapped.end(), _Values.begin());
+    _File.reset();
 }
 
 TimeSeries TimeSeries::tendencySeries() const {
     if (size() == 0)
         return TimeSeries ();
 
-    QVector <float> v (size());
-    v[0] = 0;
-    const auto coded = encoded();
-    for (int i = 1; i < size(); ++i) {
-        if (coded[i] > coded[i - 1])
-            v[i] = 1;
-        else if (coded[i] < coded[i - 1])
-            v[i] = -1;
-        else
-            v[i] = 0;
-    }
-    TimeSeries ans (std::move (v));
+    encoded();
+    TimeSeries ans (_Tendency);
     ans.setNLevels(3);
     return ans;
 }
@@ -81,36 +89,39 @@ TimeSeries TimeSeries::tendencySeries() const {
 double TimeSeries::harmonicComplexity() const {
     /// The C# source for this function has been graciously donated
     /// by nastyaloginovaa@gmail.com
-    const int n = _Values.size();
-    // sin (A) and cos (B) coefficients of a Fourier series
-    QVector <double> A (n/2, 0.), B(n/2, 0.);
+    const int n = size();
+    const auto values = this->values();
+    // amplitudes of the Fourier series
+    QVector <double> R (n/2);
 
-    {
-        QVector <double> fiA (n, 0.), fiB(n, 0.);
-        TimeSeries corrected = *this;
-        corrected.removeTrend();
+    if (n / 2 > 0) {
+        // the values are detrended on the fly
+        const float avg = statistics().mean;
+
+        // The coefficients are integrals over the period (n - 1) by the trapezoid rule,
+        // i.e. a plain DFT of length (n - 1) with the first sample replaced
+        // by the mean of the first and the last ones.
+        const int period = n - 1;
+        QVector <double> y (period);
+        y[0] = ((values[0] - avg) + (values[n - 1] - avg)) / 2.;
+        for (int i = 1; i < period; ++i)
+            y[i] = values[i] - avg;
+
+        QVector <RealFFT::complex> spectrum (period / 2 + 1);
+        RealFFT::plan(period)->transform(y.constData(), spectrum.data());
 
         for (int k = 0; k < n / 2; ++k) {
-            for (int i = 0; i < n; ++i) {
-                fiB[i] = corrected[i] * sin(M_2PI * k * i / (n - 1));
-                fiA[i] = corrected[i] * cos(M_2PI * k * i / (n - 1));
-            }
-            double sumA = 0., sumB = 0.;
-            for (int i = 1; i < n - 1; ++i) {
-                sumB += fiB[i];
-                sumA += fiA[i];
-            }
-
-            B[k] = fabs(2. / (n - 1) * ((fiB[0] + fiB[n - 1]) / 2. + sumB));
-            A[k] = fabs(2. / (n - 1) * ((fiA[0] + fiA[n - 1]) / 2. + sumA));
+            // cos (A) and sin (B) coefficients of a Fourier series
+            double A = fabs (2. / period * spectrum[k].real()),
+                   B = fabs (2. / period * spectrum[k].imag());
+            R[k] = sqrt (A * A + B * B);
         }
     }
 
-    // amplitudes of the Fourier series
-    QVector <double> R (n/2);
-    for (int i = 0; i < n / 2; ++i)
-        R[i] = sqrt (A[i] * A[i] + B[i] * B[i]);
+    return _HarmonicComplexity (R);
+}
 
+double TimeSeries::_HarmonicComplexity(QVector <double>& R) {
     std::sort (R.begin(), R.end(), [](float a, float b){return b < a;});
     double sum = std::accumulate (R.begin(), R.end(), 0.);
     double complexity = 0.;
@@ -120,109 +131,236 @@ double TimeSeries::harmonicComplexity() const {
     return complexity;
 }
 
-double TimeSeries::herstValue() const {
+double TimeSeries::herstValue(HurstEstimator method) const {
     if (size() < 2) {
         return std::numeric_limits<double>::quiet_NaN();
     }
+    if (method != HurstEstimator::wholeSeries)
+        return HurstEngine (values().data(), size()).estimate(method);
 
-    const int n = _Values.size();
+    const auto& stats = statistics();
+    double R = stats.range;
+    double S = sqrt (stats.variance);
 
-    // выборочное среднее
-    const double MX = [this, n]{
-        auto ans = 0.;
-        for (auto v : _Values)
-            ans += v;
-        ans /= n;
-        return ans;
-    }();
+    return log (R/S) / log(size());
+}
+
+namespace {
+/// The second encoding pass goes by blocks that stay in L1 after the quantizer
+constexpr int encodeBlock = 2048;
 
+/// the second pass of @c TimeSeries::_Encode for the codes of the given width
+template <typename code_t>
+void encode (const float* values, int n, unsigned nLevels,
+             TimeSeries::statistics_t& stats, code_t* codes, float* tendency) {
+    const double MX = stats.mean;
+    const float step = (stats.sup - stats.inf) / nLevels;
     double EX = 0., S = 0.;
-    double Wmax = _Values [0] - MX,
+    double Wmax = values[0] - MX,
            Wmin = Wmax;
-    for (int i = 0; i < n; ++i) {
-        EX += _Values[i];
-        auto W = EX - (i+1) * MX;
-        if (W > Wmax)
-            Wmax = W;
-        else if (W < Wmin)
-            Wmin = W;
-
-        S += pow((_Values[i] - MX), 2);
+    for (int begin = 0; begin < n; begin += encodeBlock) {
+        const int end = std::min (n, begin + encodeBlock);
+        if (step > 0)
+            quantize (values + begin, end - begin, stats.inf, step, nLevels - 1, codes + begin);
+        else // constant series
+            std::fill (codes + begin, codes + end, 0);
+
+        for (int i = begin; i < end; ++i) {
+            const float value = values[i];
+            EX += value;
+            const double W = EX - (i + 1) * MX;
+            Wmax = W > Wmax ? W : Wmax;
+            Wmin = W < Wmin ? W : Wmin;
+            S += (value - MX) * (value - MX);
+
+            tendency[i] = i == 0 ? 0.f
+                                 : static_cast <float> (codes[i] > codes[i - 1])
+                                 - static_cast <float> (codes[i] < codes[i - 1]);
+        }
     }
+    stats.variance = S / n;
+    stats.range = Wmax - Wmin;
+}
 
-    double R = Wmax - Wmin;
-    S = sqrt (S/n);
-
-    return log (R/S) / log(n);
+/// Codes and tendency of the values [begin; end) appended to an encoded series
+template <typename code_t>
+void encodeAppended (const float* values, int begin, int end, unsigned nLevels,
+                     const TimeSeries::statistics_t& stats, code_t* codes, float* tendency) {
+    const float step = (stats.sup - stats.inf) / nLevels;
+    if (step > 0)
+        quantize (values + begin, end - begin, stats.inf, step, nLevels - 1, codes + begin);
+    else // constant series
+        std::fill (codes + begin, codes + end, 0);
+    for (int i = begin; i < end; ++i)
+        tendency[i] = i == 0 ? 0.f
+                             : static_cast <float> (codes[i] > codes[i - 1])
+                             - static_cast <float> (codes[i] < codes[i - 1]);
+}
 }
 
 void TimeSeries::_Encode() const {
-    _Encoded.clear();
+    const int n = size();
+    const float* values = this->values().data();
+    _CodeWidth = CodeSpan::widthFor(_NLevels);
+    _Codes.resize(n * _CodeWidth);
+    _Tendency.resize(n);
+    _Deviations.clear();
+    _Words.clear();
     dirty = false;
-    if (_Values.isEmpty())
+    if (n == 0) {
+        _Statistics = statistics_t {0.f, 0.f, 0., 0., 0.};
         return;
+    }
 
-    auto range = getLimits();
-    float step = (range.sup - range.inf) / _NLevels;
-    for (auto value : _Values) {
-        unsigned code = (value - range.inf) / step;
-        if (code == _NLevels)
-            --code;
-        _Encoded.append(code);
+    statistics_t& stats = _Statistics;
+    double sum;
+    minMaxSum (values, n, stats.inf, stats.sup, sum);
+    stats.mean = sum / n;
+
+    // Everything else depends on the limits and the mean, so it shares the second pass:
+    // the deviations, their cumulative sums, the codes and the tendency of the codes.
+    void* codes = _Codes.data();
+    switch (_CodeWidth) {
+    case 1:
+        encode (values, n, _NLevels, stats, static_cast <uint8_t*> (codes), _Tendency.data());
+        break;
+    case 2:
+        encode (values, n, _NLevels, stats, static_cast <uint16_t*> (codes), _Tendency.data());
+        break;
+    default:
+        encode (values, n, _NLevels, stats, static_cast <uint32_t*> (codes), _Tendency.data());
     }
 }
 
-TimeSeries::symbolicDiversity_t TimeSeries::symbolicDiversity() const {
-    const int n = _Values.size();
-    const auto& coded = encoded();
-    int m;
+void TimeSeries::append(const float* values, int n) {
+    if (n <= 0)
+        return;
+    _Detach ();
+    const int begin = _Values.size(),
+              end = begin + n;
+    _Values.resize(end);
+    std::copy (values, values + n, _Values.begin() + begin);
+    _Online = true;
+    if (dirty)
+        // everything is computed by the next query anyway
+        return;
 
-    struct word_t {
-        using value_t = unsigned long;
-        value_t value = 0;
-        word_t (value_t v) : value (v) {}
-        operator value_t& () {
-            return value;
-        }
-        operator value_t () const {
-            return value;
-        }
-    };
+    statistics_t& stats = _Statistics;
+    float inf, sup;
+    double sum;
+    minMaxSum (values, n, inf, sup, sum);
+    if (begin == 0 or inf < stats.inf or sup > stats.sup) {
+        // the codes of all the values change
+        dirty = true;
+        return;
+    }
 
-    using frequencies_t = QMap <word_t, unsigned>;
+    if (_Deviations.size() != begin) {
+        _Deviations.clear();
+        for (int i = 0; i < begin; ++i)
+            _Deviations.add(_Values[i]);
+    }
+    // Welford's update keeps the variance accurate without a second pass
+    double mean = stats.mean,
+           M2 = stats.variance * begin;
+    for (int i = begin; i < end; ++i) {
+        const double x = _Values[i],
+                     delta = x - mean;
+        mean += delta / (i + 1);
+        M2 += delta * (x - mean);
+        _Deviations.add(x);
+    }
+    stats.mean = mean;
+    stats.variance = M2 / end;
+    stats.range = _Deviations.range(mean);
+
+    _Codes.resize(end * _CodeWidth);
+    _Tendency.resize(end);
+    void* codes = _Codes.data();
+    switch (_CodeWidth) {
+    case 1:
+        encodeAppended (_Values.constData(), begin, end, _NLevels, stats,
+                        static_cast <uint8_t*> (codes), _Tendency.data());
+        break;
+    case 2:
+        encodeAppended (_Values.constData(), begin, end, _NLevels, stats,
+                        static_cast <uint16_t*> (codes), _Tendency.data());
+        break;
+    default:
+        encodeAppended (_Values.constData(), begin, end, _NLevels, stats,
+                        static_cast <uint32_t*> (codes), _Tendency.data());
+    }
+
+    if (_Words.maxLength() > 0 and _Words.size() == begin) {
+        const CodeSpan coded = encoded();
+        for (int i = begin; i < end; ++i)
+            _Words.append(coded[i]);
+    }
+}
+
+namespace {
+/// The word lengths counted by @c TimeSeries::append at first
+constexpr int initialWordLength = 8;
+
+/**
+ * @brief How many times the normed window the scan over the word lengths goes before
+ *  the curve of all of them is found at once by @c TimeSeries::blockEntropy.
+ *
+ * Most of the series stop within a couple of windows, where the scan costs less than
+ * the suffix array; the repetitive ones go on to the length of their period.
+ */
+constexpr int scanWindows = 4;
+
+/// @return false if the scan has gone beyond the word length @p maxLength and stopped
+template <typename code_t>
+bool symbolicDiversity (const code_t* coded, int n, unsigned nLevels, int maxLength,
+                        TimeSeries::symbolicDiversity_t& ans) {
+    const WordCounter::key_t L = nLevels;
+    int m;
+
+    // Words of the current length m are kept as their numbers among the distinct ones,
+    // so the word of length m + 1 starting at i is exactly the pair (words[i], coded[i+m])
+    // and its key words[i]·L + coded[i+m] never exceeds n·L whatever m is.
+    std::vector <unsigned> words (n);
+    WordCounter ci; //частоты встречаемости слов
 
     double Cm_prev = 0., dC_prev = 0.;
 
     {
-        frequencies_t ci; //вектор частотной встречаемости слов
-        for (auto c : coded)
-            ++ci [c];
+        ci.reset(L, n);
+        for (int i = 0; i < n; ++i)
+            words[i] = ci.add(coded[i]);
 
-        for (double c : ci.values()) {
+        ci.forEachCount([&Cm_prev, n, nLevels](double c){
             double f = c / n;
-            Cm_prev -= f * (log (f)) / log (nLevels());
-        }
+            Cm_prev -= f * (log (f)) / log (nLevels);
+        });
     }
 
+    // once all the words are unique, the longer ones are unique as well
+    bool unique = false;
     for (m = 2; m <= n; ++m) {
-        frequencies_t ci;
-        for (int left_bound = 0; left_bound <= n - m; ++left_bound) {//цикл по словам временного ряда
-            word_t word = coded [left_bound];
-            for (int right_bound = left_bound + 1; right_bound < left_bound + m; ++right_bound){
-                word *= nLevels();
-                word += coded [right_bound];
-            }
-            ++ci [word];
+        if (m > maxLength)
+            return false;
+        const int nWords = n - m + 1;
+        unique = unique or ci.distinct() == static_cast <unsigned> (nWords + 1);
+        if (not unique) {
+            ci.reset(ci.distinct() * L, nWords);
+            for (int left_bound = 0; left_bound < nWords; ++left_bound) //цикл по словам временного ряда
+                words[left_bound] = ci.add(words[left_bound] * L + coded[left_bound + m - 1]);
         }
 
         double Cm = 0.;
         {
-            const double log_nwords = log (pow (nLevels(), m)); //log числа возможных слов длины m над алфавитом abc
-            const double dl = n - m + 1;
-            for (double c : ci.values()) {
-                double f = c / dl;
-                Cm -= f * log (f) / log_nwords;
-            }
+            const double log_nwords = log (pow (nLevels, m)); //log числа возможных слов длины m над алфавитом abc
+            const double dl = nWords;
+            if (unique)
+                Cm = log (dl) / log_nwords;
+            else
+                ci.forEachCount([&Cm, dl, log_nwords](double c){
+                    double f = c / dl;
+                    Cm -= f * log (f) / log_nwords;
+                });
         }
 
         auto dC = Cm_prev - Cm;
@@ -234,9 +372,106 @@ TimeSeries::symbolicDiversity_t TimeSeries::symbolicDiversity() const {
     }
 
     double window = static_cast <double> (m - 1) /
-                                        floor(log(n) / log(nLevels()));
-    return symbolicDiversity_t {
+                                        floor(log(n) / log(nLevels));
+    ans = TimeSeries::symbolicDiversity_t {
         window,
         dC_prev
     };
+    return true;
+}
+}
+
+TimeSeries::symbolicDiversity_t TimeSeries::symbolicDiversity() const {
+    if (_Online and size() > 1) {
+        // the word counts are kept from now on
+        const CodeSpan coded = encoded();
+        if (_Words.size() != size() or _Words.maxLength() == 0)
+            _Words.rebuild(coded, _NLevels, std::max (_Words.maxLength(), initialWordLength));
+        symbolicDiversity_t ans;
+        while (not _Words.symbolicDiversity(ans.window, ans.maxdiff))
+            _Words.rebuild(coded, _NLevels, 2 * _Words.maxLength());
+        return ans;
+    }
+    const int n = size();
+    const int maxLength = std::max (2., scanWindows * floor (log (n) / log (nLevels())));
+    symbolicDiversity_t ans;
+    const bool scanned = encoded().visit([this, n, maxLength, &ans](const auto* coded){
+        return ::symbolicDiversity (coded, n, nLevels(), maxLength, ans);
+    });
+    // the same values, for the cost of the suffix array however far the words go
+    return scanned ? ans : blockEntropy().diversity;
+}
+
+double TimeSeries::lempelZivComplexity(const CodeSpan& codes, unsigned nLevels) {
+    const int n = codes.size();
+    if (n < 2)
+        return 0.;
+    const QVector <int> lpf = SuffixArray (codes, nLevels).longestPreviousFactors();
+    int nPhrases = 0;
+    for (int i = 0; i < n; i += lpf[i] + 1)
+        ++nPhrases;
+    return nPhrases * log (n) / (n * log (nLevels));
+}
+
+TimeSeries::blockEntropy_t TimeSeries::blockEntropy() const {
+    const int n = size();
+    const SuffixArray sa (encoded(), nLevels());
+    const auto& lcp = sa.lcp();
+
+    // Words of length m are the groups of adjacent suffixes sharing m first symbols,
+    // i.e. the lcp-intervals. An interval of s suffixes with the common prefix l,
+    // whose enclosing interval has the common prefix p, is a word occurring s times
+    // for every m in (p; l]. The words occurring once add nothing to Σ c·log c.
+    // sumClogC[m] accumulates Σ c·log c for the words of length m as a difference array.
+    QVector <double> sumClogC (n + 2, 0.);
+    auto addInterval = [&sumClogC](int l, int p, int s) {
+        const double v = s * log (s);
+        sumClogC[p + 1] += v;
+        sumClogC[l + 1] -= v;
+    };
+
+    struct interval_t {
+        int lcp, lb;
+    };
+    QVector <interval_t> stack;
+    stack.append(interval_t {0, 0});
+    for (int i = 1; i <= n; ++i) {
+        const int h = i < n ? lcp[i] : 0;
+        int lb = i - 1;
+        while (h < stack.last().lcp) {
+            const interval_t top = stack.last();
+            stack.removeLast();
+            addInterval(top.lcp, std::max (h, stack.last().lcp), i - top.lb);
+            lb = top.lb;
+        }
+        if (h > stack.last().lcp)
+            stack.append(interval_t {h, lb});
+    }
+
+    blockEntropy_t ans;
+    ans.C.resize(n);
+    double s = 0.;
+    for (int m = 1; m <= n; ++m) {
+        s += sumClogC[m];
+        const double dl = n - m + 1;
+        // H = -Σ (c/dl)·log (c/dl) = log (dl) - Σ c·log c / dl
+        ans.C[m - 1] = (log (dl) - s / dl) / (m * log (nLevels()));
+    }
+
+    double Cm_prev = n > 0 ? ans.C[0] : 0.,
+           dC_prev = 0.;
+    int m;
+    for (m = 2; m <= n; ++m) {
+        auto dC = Cm_prev - ans.C[m - 1];
+        if (dC < dC_prev)
+            break;
+
+        dC_prev = dC;
+        Cm_prev = ans.C[m - 1];
+    }
+
+    ans.diversity.window = static_cast <double> (m - 1) /
+                                        floor(log(n) / log(nLevels()));
+    ans.diversity.maxdiff = dC_prev;
+    return ans;
 }
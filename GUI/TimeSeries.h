@@ -3,23 +3,48 @@
 
 #include <QVector>
 
+#include <memory>
+
+#include "DeviationRange.h"
+#include "Hurst.h"
+#include "SeriesFile.h"
+#include "Span.h"
+#include "WordStatistics.h"
+
 class TimeSeries {
 public:
     TimeSeries(QVector<float> values = QVector <float>());
 
+    /// Read the values from a .tsb file (see @c SeriesFile) or a text file with a value per line
     void readFile (const QString& fileName);
 
-    const QVector <float>& values() const noexcept {
-        return _Values;
+    /// The values, either owned or mapped from a .tsb file
+    Span <const float> values() const noexcept {
+        return _File ? _File->values()
+                     : Span <const float> (_Values.constData(), _Values.size());
     }
     float operator[] (int index) const {
-        return _Values[index];
+        return values()[index];
     }
     void setValues(QVector <float> v) {
         _Values = std::move (v);
+        _File.reset();
         dirty = true;
     }
 
+    /**
+     * @brief append the values to the end of the series.
+     *
+     * Once the series has been appended to, the statistics, the codes, the tendency
+     * and the word counts for @c symbolicDiversity() are updated in place
+     * in amortized O(1) per value, unless the new values fall out of the current limits:
+     * the codes of all the values change then, and the next query encodes the series anew.
+     */
+    void append (const float* values, int n);
+    void append (float value) {
+        append (&value, 1);
+    }
+
     unsigned nLevels () const noexcept {
         return _NLevels;
     }
@@ -28,11 +53,24 @@ public:
         dirty = true;
     }
 
-    const QVector <unsigned>& encoded() const;
+    /// The series encoded with @c nLevels() symbols, see @c _Codes
+    CodeSpan encoded() const;
     struct limits {
         float inf, sup;
     };
     limits getLimits () const;
+
+    /// Summary of the values shared by all the metrics
+    struct statistics_t {
+        float inf, sup;
+        double mean;
+        /// Σ (x - mean)² / n
+        double variance;
+        /// max - min of the cumulative deviations from the mean, R of the R/S analysis
+        double range;
+    };
+    /// Statistics of the values, computed along with @c encoded() once per change
+    const statistics_t& statistics () const;
     void removeTrend ();
     /**
      * @brief return tendency series, where each value is replaced by 0 or ±1,
@@ -48,9 +86,17 @@ public:
      */
     double harmonicComplexity () const;
 
-    double herstValue() const;
+    /**
+     * @brief estimate the Hurst exponent.
+     *
+     * The default @c HurstEstimator::wholeSeries is the single R/S ratio
+     * over the whole series, see @c HurstEngine for the others.
+     */
+    double herstValue(HurstEstimator method = HurstEstimator::wholeSeries) const;
 
-    double fractalDimensionality () const { return 2 - herstValue(); }
+    double fractalDimensionality (HurstEstimator method = HurstEstimator::wholeSeries) const {
+        return 2 - herstValue(method);
+    }
     /// Measure of symbolic diversity values
     struct symbolicDiversity_t {
         double window; ///< normed window size
@@ -58,30 +104,86 @@ public:
     };
     symbolicDiversity_t symbolicDiversity () const;
 
-    int size() const { return _Values.size(); }
+    /// Normed block entropy for all the word lengths
+    struct blockEntropy_t {
+        /// C[m - 1] is the normed entropy of the words of length m, m = 1..size()
+        QVector <double> C;
+        /// the same value as @c symbolicDiversity() gives
+        symbolicDiversity_t diversity;
+    };
+    /**
+     * @brief compute the whole entropy curve in one sweep over the suffix array of @c encoded().
+     *
+     * Costs O(n log n) no matter how long @c symbolicDiversity() would scan the word lengths.
+     */
+    blockEntropy_t blockEntropy () const;
+
+    /**
+     * @brief the Lempel–Ziv complexity of @c encoded(), see the static overload.
+     */
+    double lempelZivComplexity () const {
+        return lempelZivComplexity (encoded(), nLevels());
+    }
+    /**
+     * @brief the Lempel–Ziv (1976) complexity of the @p codes less than @p nLevels.
+     *
+     * The number c of phrases the codes are parsed into, each being the longest
+     * factor seen before, maybe overlapping it, and one more code, normalized
+     * by its asymptotic value for random sequences: c·log_nLevels (n) / n.
+     * The factors come from the suffix array in O(n) once it is built.
+     */
+    static double lempelZivComplexity (const CodeSpan& codes, unsigned nLevels);
+
+    int size() const { return _File ? _File->size() : _Values.size(); }
 private:
+    /// the batch encodes its series for them, see @c SeriesBatch::shareEncoding
+    friend class SeriesBatch;
+
     /// How many intervals are there in the values domain
     unsigned _NLevels = 8;
-    /// The real value of the series
+    /// The real value of the series, unless they are mapped from @c _File
     QVector <float> _Values;
+    /// The .tsb file the values are mapped from, shared by the copies of the series
+    std::shared_ptr <const SeriesFile> _File;
     /**
      * @brief The encoded version of the series
      *
      * The values domain is separated into @c nLevels half-segments of the form
      * [a_i; a_{i+1}); the last half-segment is actually a segment.
      * Then each value is replaced with the number of the corresponding half-segment.
+     *
+     * Each code takes @c _CodeWidth bytes, see @c CodeSpan.
      */
-    mutable QVector <unsigned> _Encoded;
+    mutable QVector <uint8_t> _Codes;
+    mutable unsigned _CodeWidth = 1;
+    /// Values of the @c tendencySeries(), derived from @c _Codes
+    mutable QVector <float> _Tendency;
+    mutable statistics_t _Statistics;
 
     /**
-     * @brief update the @c _Encoded variable.
+     * @brief update the @c _Statistics, @c _Codes and @c _Tendency variables.
+     *
+     * The limits and the sum are found by one vectorized pass,
+     * everything else depends on them and is done by the second one,
+     * which quantizes the values by vectorized blocks.
      *
      * This function is declared as const since it is legit
      *  to call it from other const functions.
      */
     void _Encode () const;
+    /// The complexity by the amplitudes of the Fourier series, which are sorted in place
+    static double _HarmonicComplexity (QVector <double>& amplitudes);
+    /// Copy the mapped values to @c _Values to change them
+    void _Detach ();
+
+    /// Whether the series has been appended to, so it maintains the incremental state below
+    bool _Online = false;
+    /// Cumulative deviations of the first @c _Deviations.size() values
+    mutable DeviationRange _Deviations;
+    /// Word counts of the first @c _Words.size() codes, if @c _Words.maxLength() > 0
+    mutable WordStatistics _Words;
 
-    /// Does the @c endoded series contain the actual data same as @c values
+    /// Do the @c endoded series and the @c statistics correspond to the @c values
     mutable bool dirty = true;
 };
 
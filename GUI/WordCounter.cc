@@ -0,0 +1,45 @@
+#include "WordCounter.h"
+
+#include <algorithm>
+
+namespace {
+/// Key spaces up to this size are always counted directly
+constexpr WordCounter::key_t minDirectSpace = 1 << 16;
+}
+
+void WordCounter::reset(key_t keySpace, int nWords) {
+    const key_t maxDirectSpace = std::max (minDirectSpace, 4ull * nWords);
+    _Counts.clear();
+    _Direct = keySpace <= maxDirectSpace;
+    if (_Direct) {
+        _Slots.assign(keySpace, 0);
+        return;
+    }
+
+    // keep the load factor at most 1/2
+    unsigned bits = 1;
+    while ((size_t (1) << bits) < 2 * static_cast <size_t> (nWords))
+        ++bits;
+    const size_t capacity = size_t (1) << bits;
+    _Mask = capacity - 1;
+    _Shift = 64 - bits;
+    _Slots.assign(capacity, 0);
+    _Keys.resize(capacity);
+}
+
+void WordCounter::_Grow() {
+    std::vector <unsigned> slots;
+    std::vector <key_t> keys;
+    std::swap (slots, _Slots);
+    std::swap (keys, _Keys);
+
+    const unsigned bits = 64 - _Shift + 1;
+    const size_t capacity = size_t (1) << bits;
+    _Mask = capacity - 1;
+    _Shift = 64 - bits;
+    _Slots.assign(capacity, 0);
+    _Keys.resize(capacity);
+    for (size_t i = 0; i < slots.size(); ++i)
+        if (slots[i] != 0)
+            _Slots[_Find (keys[i])] = slots[i];
+}
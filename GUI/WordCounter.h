@@ -0,0 +1,98 @@
+#ifndef WORDCOUNTER_H_8fa9830f_1c01_4990_be78_a20fff660b2b
+#define WORDCOUNTER_H_8fa9830f_1c01_4990_be78_a20fff660b2b
+
+// for size_t
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Frequencies of words encoded as integer keys.
+ *
+ * Each distinct key gets a dense number 0, 1, 2... in the order of appearance,
+ * so the words of the next length may be keyed as (number · alphabet + symbol)
+ * and stay exact and small for any alphabet and any word length.
+ *
+ * Small key spaces are mapped by a plain array indexed by the key,
+ * larger ones by a flat open addressing hash table.
+ * The storage is reused by subsequent @c reset calls,
+ * so counting does not allocate memory per word.
+ */
+class WordCounter {
+public:
+    using key_t = unsigned long long;
+
+    /**
+     * @brief start a new count
+     * @param keySpace all the keys are less than this value
+     * @param nWords how many words at most are to be added
+     */
+    void reset (key_t keySpace, int nWords);
+
+    /// Count one more @p key and return its number
+    unsigned add (key_t key) {
+        unsigned& slot = _Direct ? _Slots[key] : _Slots[_Find (key)];
+        if (slot == 0) {
+            _Counts.push_back(0);
+            slot = _Counts.size();
+        }
+        ++_Counts[slot - 1];
+        return slot - 1;
+    }
+
+    /**
+     * @brief Like @c add, but does not rely on the @c nWords given to @c reset:
+     *  the hash table doubles once it gets half full.
+     */
+    unsigned addGrowing (key_t key) {
+        if (not _Direct and 2 * (_Counts.size() + 1) > _Slots.size())
+            _Grow();
+        return add (key);
+    }
+
+    /// Uncount the key number @p id once and return how many times it is left counted
+    unsigned remove (unsigned id) {
+        return --_Counts[id];
+    }
+
+    /// How many times the key number @p id has been added
+    unsigned count (unsigned id) const {
+        return _Counts[id];
+    }
+
+    /// How many distinct keys have been added
+    unsigned distinct () const noexcept {
+        return _Counts.size();
+    }
+
+    /// Call @p f (count) for each distinct word
+    template <typename F>
+    void forEachCount (F&& f) const {
+        for (unsigned c : _Counts)
+            f (c);
+    }
+
+private:
+    /// double the hash table keeping the key numbers
+    void _Grow ();
+
+    /// find the hash table slot for @p key, reserve an empty one if it is new
+    size_t _Find (key_t key) {
+        size_t i = (key * 0x9E3779B97F4A7C15ull) >> _Shift;
+        while (_Slots[i] != 0 and _Keys[i] != key)
+            i = (i + 1) & _Mask;
+        _Keys[i] = key;
+        return i;
+    }
+
+    bool _Direct = true;
+    /// (number + 1) of the key, indexed by the key or by the hash table slot; 0 if empty
+    std::vector <unsigned> _Slots;
+    /// keys of the hash table slots
+    std::vector <key_t> _Keys;
+    /// counts by the key numbers
+    std::vector <unsigned> _Counts;
+    size_t _Mask = 0;
+    unsigned _Shift = 64;
+};
+
+#endif // WORDCOUNTER_H
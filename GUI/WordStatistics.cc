@@ -0,0 +1,111 @@
+#include "WordStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+/// The initial hash table size, it grows as needed
+constexpr int initialWords = 1024;
+
+/// c·log c - (c - 1)·log (c - 1)
+double clogcIncrement (double c) {
+    return c * log (c) - (c > 1 ? (c - 1) * log (c - 1) : 0.);
+}
+}
+
+void WordStatistics::reset(unsigned nLevels, int maxLength, int window) {
+    _NLevels = nLevels;
+    _Window = window;
+    _First = 0;
+    _Size = 0;
+    _Levels.resize(maxLength);
+    for (int m = 1; m <= maxLength; ++m) {
+        level_t& level = _Levels[m - 1];
+        // the longer words are keyed by (number · nLevels + code) with no a priori bound
+        level.counter.reset(m == 1 ? nLevels : std::numeric_limits <WordCounter::key_t>::max(),
+                            initialWords);
+        level.sumClogC = 0.;
+        level.distinct = 0;
+        level.last = 0;
+        level.ids.assign(window, 0);
+    }
+}
+
+void WordStatistics::clear() {
+    _Levels.clear();
+    _First = 0;
+    _Size = 0;
+}
+
+void WordStatistics::rebuild(const CodeSpan& codes, unsigned nLevels, int maxLength, int window) {
+    reset (nLevels, maxLength, window);
+    codes.visit([this, &codes](const auto* c){
+        for (int i = 0; i < codes.size(); ++i)
+            append (c[i]);
+    });
+}
+
+void WordStatistics::append(unsigned code) {
+    ++_Size;
+    const long long end = _First + _Size;
+    const int top = std::min (_Size, maxLength());
+    // the longer words go first, so that the shorter ones still end at the previous code
+    for (int m = top; m >= 1; --m) {
+        level_t& level = _Levels[m - 1];
+        const WordCounter::key_t key = m == 1
+                ? code
+                : _Levels[m - 2].last * WordCounter::key_t (_NLevels) + code;
+        const unsigned id = level.counter.addGrowing(key);
+        const double c = level.counter.count(id);
+        level.sumClogC += clogcIncrement (c);
+        level.distinct += c == 1;
+        level.last = id;
+        if (_Window > 0)
+            level.ids[(end - m) % _Window] = id;
+    }
+}
+
+void WordStatistics::removeFirst() {
+    const int top = std::min (_Size, maxLength());
+    for (int m = 1; m <= top; ++m) {
+        level_t& level = _Levels[m - 1];
+        const double c = level.counter.remove(level.ids[_First % _Window]);
+        level.sumClogC -= clogcIncrement (c + 1);
+        level.distinct -= c == 0;
+    }
+    ++_First;
+    --_Size;
+}
+
+bool WordStatistics::symbolicDiversity(double& window, double& maxdiff) const {
+    const int n = size();
+    int m;
+
+    // -Σ f·log f = log N - Σ c·log c / N for the frequencies f = c / N
+    // a single word has no entropy, the difference of the logarithms would only be noise
+    double Cm_prev = distinct(1) == 1 ? 0. : (log (n) - sumClogC(1) / n) / log (_NLevels),
+           dC_prev = 0.;
+    bool unique = distinct(1) == static_cast <unsigned> (n);
+    for (m = 2; m <= n; ++m) {
+        const int nWords = n - m + 1;
+        if (not unique and m > maxLength())
+            return false;
+        unique = unique or distinct(m) == static_cast <unsigned> (nWords);
+
+        const double log_nwords = log (pow (_NLevels, m));
+        const double Cm = unique ? log (nWords) / log_nwords
+                        : distinct(m) == 1 ? 0.
+                        : (log (nWords) - sumClogC(m) / nWords) / log_nwords;
+
+        auto dC = Cm_prev - Cm;
+        if (dC < dC_prev)
+            break;
+        dC_prev = dC;
+        Cm_prev = Cm;
+    }
+
+    window = static_cast <double> (m - 1) / floor(log(n) / log(_NLevels));
+    maxdiff = dC_prev;
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef WORDSTATISTICS_H_0d83f5b6_47a2_4c19_b8e3_61f9a2c7d450
+#define WORDSTATISTICS_H_0d83f5b6_47a2_4c19_b8e3_61f9a2c7d450
+
+#include <vector>
+
+#include "Span.h"
+#include "WordCounter.h"
+
+/**
+ * @brief Counts of the words of the lengths 1..maxLength() in a growing
+ *  or sliding sequence of codes.
+ *
+ * Appending a code adds one word of each length, the one ending at the new code.
+ * The word of length m ending here is the word of length m - 1 ending at the previous code
+ * extended by the new one, so it is keyed by the number of that shorter word
+ * as in @c TimeSeries::symbolicDiversity and stays exact for any alphabet.
+ * Σ c·log c over the words of each length is updated along with the counts,
+ * so appending takes O(maxLength()) and the block entropies are available at once.
+ *
+ * With a non-zero window the numbers of the words in the window are kept as well,
+ * so the first code may be removed in O(maxLength()) too.
+ */
+class WordStatistics {
+public:
+    /// Forget everything and free the memory, maxLength() becomes 0
+    void clear ();
+    /**
+     * @brief forget everything
+     * @param nLevels the codes are to be less than this
+     * @param window how many codes at most are counted at once to be able
+     *  to @c removeFirst, 0 if the codes are only appended
+     */
+    void reset (unsigned nLevels, int maxLength, int window = 0);
+    /// Count the words of @p codes from scratch
+    void rebuild (const CodeSpan& codes, unsigned nLevels, int maxLength, int window = 0);
+
+    /// How many codes are counted
+    int size () const noexcept { return _Size; }
+    int maxLength () const noexcept { return _Levels.size(); }
+
+    void append (unsigned code);
+    /// Forget the first of the counted codes, only if the window is non-zero
+    void removeFirst ();
+
+    /// How many distinct words of length @p m, 1 <= m <= maxLength(), there are
+    unsigned distinct (int m) const {
+        return _Levels[m - 1].distinct;
+    }
+    /// Σ c·log c over the counts c of the words of length @p m
+    double sumClogC (int m) const {
+        return _Levels[m - 1].sumClogC;
+    }
+
+    /**
+     * @brief the measure of symbolic diversity of the counted codes,
+     *  see @c TimeSeries::symbolicDiversity.
+     * @return false if the words longer than @c maxLength() are needed for that
+     */
+    bool symbolicDiversity (double& window, double& maxdiff) const;
+
+private:
+    struct level_t {
+        WordCounter counter;
+        double sumClogC = 0.;
+        /// How many words have non-zero counts
+        unsigned distinct = 0;
+        /// the number of the word of this length ending at the last code
+        unsigned last = 0;
+        /// the numbers of the words in the window by their starting positions modulo the window
+        std::vector <unsigned> ids;
+    };
+    std::vector <level_t> _Levels;
+    unsigned _NLevels = 0;
+    int _Window = 0;
+    /// The position of the first counted code since the last reset
+    long long _First = 0;
+    int _Size = 0;
+};
+
+#endif // WORDSTATISTICS_H
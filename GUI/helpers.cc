@@ -17,22 +17,6 @@ void setErrorBackground(QWidget *w,
 }
 
 
-const char* coordinates_t::coordinateName(size_t index) {
-    switch (index) {
-    case 0: return "Гармоническая сложность";
-    case 1: return "Гармоническая сложность тенденций";
-    case 2: return "Фрактальная размерность";
-    case 3: return "Фрактальная размерность тенденций";
-    case 4: return "Символьное разнообразие: окно";
-    case 5: return "Символьное разнообразие тенденций: окно";
-    case 6: return "Символьное разнообразие: разность";
-    case 7: return "Символьное разнообразие тенденций: разность";
-    case 8: return "Колмогоровская сложность";
-    case 9: return "Колмогоровская сложность тенденций";
-    }
-    return "???";
-}
-
 QString plural (const char* base,
                 const char* one,
                 const char* some,
@@ -8,27 +8,7 @@ class QWidget;
 #include <QObject>
 #include <QString>
 
-struct coordinates_t {
-    static constexpr size_t nValues = 10;
-    union {
-        double values [nValues];
-        struct {
-            double harmonicComplexity,
-                   tendencyHarmonicComplexity,
-                   fractalDimensionality,
-                   tendencyFractalDimensionality,
-                   symbolicDiversityWindow,
-                   tendencySymbolicDiversityWindow,
-                   symbolicDiversityDiff,
-                   tendencySymbolicDiversityDiff,
-                   KolmogorovComplexity,
-                   tendencyKolmogorovComplexity;
-        } by_name;
-    };
-    /// User-readable coordinate name (in Russian)
-    static const char* coordinateName (size_t index);
-};
-
+#include "Coordinates.h"
 
 /**
  * @brief set css of the given widget to the reddish or greenish background.